@@ -13,8 +13,32 @@ build="build"
 # set binary directory
 bin="bin/sudoku_solver"
 
+# set benchmark source and binary
+bench_src="src/benchmark.cpp"
+bench_bin="bin/benchmark"
+
+# set library source and binary
+lib_src="src/libsudoku.cpp"
+lib_bin="bin/libsudoku.so"
+
+# set unit test source and binary
+test_src="src/unit_test.cpp"
+test_bin="bin/unit_test"
+
 # set standard
 CppSTD="c++17"
 
+# set optimization, keep symbols for profiling
+OPT="-O2 -g"
+
 # quick building
-$CC $src -o $bin -I $include -g -std=$CppSTD
\ No newline at end of file
+$CC $src -o $bin -I $include $OPT -std=$CppSTD -pthread
+
+# benchmark building
+$CC $bench_src -o $bench_bin -I $include $OPT -std=$CppSTD -pthread
+
+# library building, only the C interface is exported and tracing is compiled out
+$CC $lib_src -o $lib_bin -I $include $OPT -std=$CppSTD -pthread -shared -fPIC -fvisibility=hidden -DSDS_TRACE_LEVEL=0
+
+# unit test building against the library, then running it
+$CC $test_src -o $test_bin -I $include $OPT -std=$CppSTD -pthread -L bin -l sudoku -Wl,-rpath,'$ORIGIN' && $test_bin
\ No newline at end of file
@@ -9,11 +9,16 @@
 
 #include "element.h"
 #include "FileHandler.h"
+#include "PuzzleReader.h"
+#include "simd.h"
+#include "trace.h"
 
 #include <cctype>
 #include <cmath>
 #include <cstdio>
+#include <cstring>
 #include <string>
+#include <vector>
 
 namespace sds
 {
@@ -64,7 +69,7 @@ namespace sds
          * @param info error information
         */
         void logError(std::string info)
-         { std::fprintf(stderr, "lexxing error: %s in line %d, col %d\r\n", info, line, col); }
+         { std::fprintf(stderr, "lexxing error: %s in line %d, col %d\r\n", info.c_str(), line, col); }
 
     public:
         /**
@@ -107,7 +112,7 @@ namespace sds
             switch (state)
             {
             case CSVState::START:
-                if (' ' == lastChar || '\t' == lastChar)
+                if (' ' == lastChar || '\t' == lastChar || '\r' == lastChar)
                     state = CSVState::S1;
                 else if (std::isdigit(lastChar))
                 {
@@ -122,12 +127,12 @@ namespace sds
                 }
                 else
                 {
-                    logError("invalid symbol " + lastChar);
+                    logError(std::string("invalid symbol ") + lastChar);
                     return CSVTokType::tok_invalid;
                 }
                 break;
             case CSVState::S1:
-                if (' ' == lastChar || '\t' == lastChar)
+                if (' ' == lastChar || '\t' == lastChar || '\r' == lastChar)
                     break;
                 else if (std::isdigit(lastChar))
                 {
@@ -142,7 +147,7 @@ namespace sds
                 }
                 else
                 {
-                    logError("invalid symbol " + lastChar);
+                    logError(std::string("invalid symbol ") + lastChar);
                     return CSVTokType::tok_invalid;
                 }
                 break;
@@ -150,8 +155,8 @@ namespace sds
                 if (std::isdigit(lastChar))
                     digitStr += lastChar;
                 else if (',' == lastChar ||
-                    ' ' == lastChar || '\n' == lastChar ||
-                    EOF == lastChar)
+                    ' ' == lastChar || '\r' == lastChar ||
+                    '\n' == lastChar || EOF == lastChar)
                 {
                     if ('\n' == lastChar)
                     {
@@ -162,7 +167,7 @@ namespace sds
                 }
                 else
                 {
-                    logError("invalid symbol " + lastChar);
+                    logError(std::string("invalid symbol ") + lastChar);
                     return CSVTokType::tok_invalid;
                 }
                 break;
@@ -175,50 +180,165 @@ namespace sds
     }
 
     /**
-     * @brief convert csv data to grid entity
-     * @param filename csv file path
-     * @return grid entity
+     * @brief parse the digits of a csv grid in one pass
+     * straight out of a buffer, no token is copied.
+     * Separators are skipped with SIMD. Invalid symbols are
+     * dropped, like CSVLexer does.
+     * @param text file content, e.g. a MappedFile
+     * @param size the number of bytes
+     * @param digits output buffer, cleared first
+     * @param limit stop after this many digits
+     * @param isReporting print each dropped symbol to stderr
+     * @return the number of dropped symbols
     */
-    static Grid* CSVtoGrid(std::string filename)
+    static unsigned long parseCSVDigits(const char* text, std::size_t size,
+        std::vector<char>& digits, std::size_t limit, bool isReporting = true);
+
+    /**
+     * @brief parse a whole puzzle text: a csv grid, or one-line
+     * puzzles (dots, digits, hexadecimal or letters) of which
+     * the first is taken. The grid size is not checked.
+     * @param text puzzle text
+     * @param size the number of bytes
+     * @param digits output row-major digits
+     * @param format output layout of the puzzle
+     * @param isReporting print dropped symbols to stderr
+     * @return false if a csv grid had invalid symbols
+    */
+    static bool parsePuzzleText(const char* text, std::size_t size,
+        std::vector<char>& digits, PuzzleFormat& format, bool isReporting);
+
+    /**
+     * @brief load a puzzle file into a grid, which is
+     * resized to fit. Safe to call from several threads
+     * with a grid each.
+     * @param filename puzzle file path
+     * @param grid grid to load into
+     * @return false if the file cannot be read or is not
+     * a sudoku
+    */
+    static bool loadGrid(const std::string& filename, Grid& grid);
+
+    static unsigned long parseCSVDigits(const char* text, std::size_t size,
+        std::vector<char>& digits, std::size_t limit, bool isReporting)
     {
-        std::string content = readText(filename);
-        std::printf("read csv file %s...done\r\n", filename.c_str());
-        int tmpChar;
-        unsigned int idx = 0;
-        char buf[content.size()];
-        CSVLexer csvlexer(content);
-        csvlexer.resetIdx();
-        for (int i = 0; i < content.size(); i++)
+        const TextKernels& kernels = textKernels();
+        const char* p = text;
+        const char* end = text + size;
+        const char* lineStart = text;
+        unsigned long line = 1;
+        unsigned long dropped = 0;
+        digits.clear();
+        while (digits.size() <= limit)
         {
-            tmpChar = csvlexer.getCSVTok();
-            if (tmpChar == CSVTokType::tok_eof)
+            p = kernels.skipSeparators(p, end);
+            if (p == end)
                 break;
-            if (tmpChar != CSVTokType::tok_empty &&
-                tmpChar != CSVTokType::tok_invalid)
+            const char c = *p;
+            if (c >= '0' && c <= '9')
+            {
+                int value = 0;
+                while (p < end && *p >= '0' && *p <= '9' && value <= 127)
+                    value = value * 10 + (*p++ - '0');
+                /* a number ends at a separator or a line end */
+                if (p == end || isSeparator(*p) || *p == '\n' || *p == EOF)
+                {
+                    if (value <= 127)
+                    {
+                        digits.push_back((char)value);
+                        continue;
+                    }
+                }
+                if (isReporting)
+                    std::fprintf(stderr, "lexxing error: invalid number in "
+                        "line %lu, col %lu\r\n", line,
+                        (unsigned long)(p - lineStart + 1));
+                dropped++;
+                while (p < end && *p >= '0' && *p <= '9')
+                    p++;
+                continue;
+            }
+            if (c == '\n' || c == EOF)
             {
-                buf[idx] = tmpChar;
-                idx++;
+                line++;
+                lineStart = ++p;
+                continue;
             }
+            if (isReporting)
+                std::fprintf(stderr, "lexxing error: invalid symbol %c in line "
+                    "%lu, col %lu\r\n", c, line,
+                    (unsigned long)(p - lineStart + 1));
+            dropped++;
+            p++;
         }
-        std::printf("csv lexing done, the number of digits = %d.\r\n", idx);
-        /* check if the grid is a square? */
-        if (
-            idx != 4*4 && idx != 9*9 && idx != 16*16 &&
-            idx != 25*25 && idx != 36*36 && idx != 49*49 &&
-            idx != 64*64 && idx != 81*81 && idx != 100*100
-        )
+        return dropped;
+    }
+
+    static bool parsePuzzleText(const char* text, std::size_t size,
+        std::vector<char>& digits, PuzzleFormat& format, bool isReporting)
+    {
+        const char* end = text + size;
+        /* the first line that is not blank tells the format */
+        const char* line = text;
+        while (line < end && std::isspace((unsigned char)*line))
+            line++;
+        const char* lineEnd = (const char*)std::memchr(line, '\n', end - line);
+        if (lineEnd == nullptr)
+            lineEnd = end;
+        bool isLine = line < end;
+        for (const char* p = line; p < lineEnd && isLine; p++)
+            isLine = !isSeparator(*p) || *p == '\r';
+        unsigned int length;
+        if (isLine && parseLinePuzzle(line, lineEnd - line, digits, length,
+            format))
+            return true;
+        format = fmt_csv;
+        return parseCSVDigits(text, size, digits, 100 * 100, isReporting) == 0;
+    }
+
+    static bool loadGrid(const std::string& filename, Grid& grid)
+    {
+        MappedFile file(filename);
+        if (!file.isOpen())
+            return false;
+        SDS_TRACE(trace_info, "read csv file %s...done\r\n", filename.c_str());
+        /* digits of the last file of this thread, reused */
+        static thread_local std::vector<char> buf;
+        PuzzleFormat format;
+        parsePuzzleText(file.Data(), file.Size(), buf, format, true);
+        if (format != fmt_csv)
+            SDS_TRACE(trace_info, "%s is a one-line puzzle file\r\n",
+                filename.c_str());
+        const unsigned int idx = buf.size();
+        SDS_TRACE(trace_info, "csv lexing done, the number of digits = %ld.\r\n",
+            (long)idx);
+        /* check if the grid is a square of a square */
+        unsigned int length;
+        if (!isGridSize(idx, length))
         {
-            std::fprintf(stderr, "error: %s is not a sudoku game file\r\n", filename);
-            return nullptr;
+            std::fprintf(stderr, "error: %s is not a sudoku game file\r\n", filename.c_str());
+            return false;
         }
-        /* initialize a grid */
-        unsigned int length = std::sqrt(idx);
-        unsigned int blocklength = std::sqrt(length);
+        /* the grid may be left over by a previous file */
+        grid.resize(length, std::sqrt(length));
+        grid.load(buf.data());
+        return true;
+    }
+
+    /**
+     * @brief convert a puzzle file to grid entity. The file
+     * is either a csv grid, or one-line puzzles (dots, digits,
+     * hexadecimal or letters) of which the first is loaded.
+     * Not reentrant, threads should use loadGrid().
+     * @param filename puzzle file path
+     * @return grid entity, shared by every call
+    */
+    static Grid* CSVtoGrid(std::string filename)
+    {
         /* add static modifier to keep grid global */
-        static Grid grid(length, blocklength);
-        for (int i = 0; i < length; i++)
-            for (int j = 0; j < length; j++)
-                grid(i, j) = buf[i * length + j];
+        static Grid grid(9, 3);
+        if (!loadGrid(filename, grid))
+            return nullptr;
         return &grid;
     }
 }
\ No newline at end of file
@@ -8,9 +8,17 @@
 *******************************************/
 
 #include <cstdio>   // fprintf
+#include <cstdlib>  // malloc
 #include <fstream>  // handling file
 #include <string>   // string
 
+#ifndef _WIN32
+#include <fcntl.h>      // open
+#include <sys/mman.h>   // mmap
+#include <sys/stat.h>   // fstat
+#include <unistd.h>     // close
+#endif
+
 namespace sds
 {
     /**
@@ -20,6 +28,54 @@ namespace sds
     */
     static std::string readText(std::string filename);
 
+    /**
+     * Read-only view of a whole file. Regular files are
+     * mapped into memory, so nothing is copied and files
+     * larger than RAM work; anything else (or a system
+     * without mmap) is read into a buffer.
+    */
+    class MappedFile
+    {
+    private:
+        /**
+         * @brief first byte of the file
+        */
+        const char* data;
+        /**
+         * @brief the number of bytes
+        */
+        std::size_t size;
+        /**
+         * @brief is data mapped (or malloc'ed)?
+        */
+        bool isMapped;
+        /**
+         * @brief did opening succeed?
+        */
+        bool isOpened;
+
+        /**
+         * @brief read a stream into a malloc'ed buffer
+        */
+        void readAll(std::FILE* stream);
+
+    public:
+        const char* Data() { return data; }
+        std::size_t Size() { return size; }
+        bool isOpen() { return isOpened; }
+        /**
+         * @brief constructor that maps a file
+         * @param filename file path
+        */
+        MappedFile(const std::string& filename);
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+        /**
+         * @brief deconstructor that unmaps the file
+        */
+        ~MappedFile();
+    };
+
     static std::string readText(std::string filename)
     {
         std::string content;
@@ -38,4 +94,84 @@ namespace sds
         tmpFile.close();
         return content;
     }
+
+    MappedFile::MappedFile(const std::string& filename)
+        : data(nullptr), size(0), isMapped(false), isOpened(false)
+    {
+#ifndef _WIN32
+        int fd = ::open(filename.c_str(), O_RDONLY);
+        if (fd >= 0)
+        {
+            struct stat info;
+            void* addr = MAP_FAILED;
+            bool isRegular = ::fstat(fd, &info) == 0 &&
+                S_ISREG(info.st_mode);
+            /* mmap refuses empty files, an empty view is fine */
+            if (isRegular && info.st_size != 0)
+                addr = ::mmap(nullptr, info.st_size, PROT_READ,
+                    MAP_PRIVATE, fd, 0);
+            ::close(fd);
+            if (isRegular && info.st_size == 0)
+            {
+                isOpened = true;
+                return;
+            }
+            if (addr != MAP_FAILED)
+            {
+                ::madvise(addr, info.st_size, MADV_SEQUENTIAL);
+                data = (const char*)addr;
+                size = info.st_size;
+                isMapped = true;
+                isOpened = true;
+                return;
+            }
+        }
+#endif
+        /* not a regular file, or no mmap: read it through */
+        std::FILE* stream = std::fopen(filename.c_str(), "rb");
+        if (stream == nullptr)
+        {
+            std::fprintf(stderr, "cannot open the file \"%s\"\r\n",
+                filename.c_str());
+            return;
+        }
+        readAll(stream);
+        std::fclose(stream);
+    }
+
+    void MappedFile::readAll(std::FILE* stream)
+    {
+        std::size_t capacity = 1 << 16;
+        char* buf = (char*)std::malloc(capacity);
+        std::size_t n;
+        while (buf != nullptr &&
+            (n = std::fread(buf + size, 1, capacity - size, stream)) > 0)
+        {
+            size += n;
+            if (size == capacity)
+            {
+                capacity *= 2;
+                char* grown = (char*)std::realloc(buf, capacity);
+                if (grown == nullptr)
+                    std::free(buf);
+                buf = grown;
+            }
+        }
+        data = buf;
+        isOpened = buf != nullptr;
+        if (!isOpened)
+            size = 0;
+    }
+
+    MappedFile::~MappedFile()
+    {
+#ifndef _WIN32
+        if (isMapped)
+        {
+            ::munmap((void*)data, size);
+            return;
+        }
+#endif
+        std::free((void*)data);
+    }
 }
\ No newline at end of file
@@ -0,0 +1,1160 @@
+/*******************************************
+ * @title   Fixed grid
+ * @brief   grid specialized at compile time
+ * with one machine word of candidates per
+ * lattice
+ * @author  Bin Qu
+ * @date    2026.10.17
+ * @copyright   You can edit and remodify
+ * this file.
+*******************************************/
+
+#include "bits.h"
+#include "element.h"
+#include "simd.h"
+#include "solver.h"
+#include "stats.h"
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace sds
+{
+    /**
+     * @brief integer square root at compile time
+    */
+    static constexpr unsigned int fixedRoot(unsigned int n)
+    {
+        unsigned int r = 0;
+        while ((r + 1) * (r + 1) <= n)
+            r++;
+        return r;
+    }
+
+    /**
+     * Grid of N*N lattices whose candidates are kept in
+     * one Word per lattice, with unit tables built at
+     * compile time. It runs the same rules as Grid (fill
+     * and i-excluding) and the same search, without any
+     * per-bit loop.
+     * @param N grid size length, a square number
+     * @param Word unsigned type with at least N bits
+    */
+    template <unsigned int N, typename Word>
+    class FixedGrid
+    {
+    public:
+        /**
+         * @brief length of block
+        */
+        static constexpr unsigned int B = fixedRoot(N);
+        /**
+         * @brief the number of lattices
+        */
+        static constexpr unsigned int S = N * N;
+        /**
+         * @brief the number of units (rows, columns, blocks)
+        */
+        static constexpr unsigned int U = 3 * N;
+        /**
+         * @brief everything a search node has to save
+        */
+        struct State
+        {
+            /* row-major lattices, 0 represents "empty" */
+            char lattices[S];
+            /* candidates of each lattice, bit k for digit k + 1 */
+            Word mask[S];
+            /* the number of empty lattices */
+            unsigned int empty;
+        };
+
+    private:
+        static_assert(B * B == N, "grid size length must be square");
+        static_assert(sizeof(Word) * 8 >= N, "Word is too narrow");
+
+        /**
+         * @brief lattices of every unit, and units of
+         * every lattice
+        */
+        struct Tables
+        {
+            unsigned short unitCells[U][N];
+            unsigned short latticeUnits[S][3];
+            constexpr Tables() : unitCells(), latticeUnits()
+            {
+                for (unsigned int i = 0; i < S; i++)
+                {
+                    unsigned int row = i / N;
+                    unsigned int col = i % N;
+                    unsigned int block = (row / B) * B + col / B;
+                    latticeUnits[i][0] = row;
+                    latticeUnits[i][1] = N + col;
+                    latticeUnits[i][2] = 2 * N + block;
+                    unitCells[row][col] = i;
+                    unitCells[N + col][row] = i;
+                    unitCells[2 * N + block][(row % B) * B + col % B] = i;
+                }
+            }
+        };
+        static constexpr Tables tables = Tables();
+
+        /**
+         * @brief the number of peers of a lattice
+        */
+        static constexpr unsigned int P = 3 * N - 2 * B - 1;
+        /**
+         * @brief whether load() builds the masks of a row with
+         * the vector kernels, they pay off from 64x64 up
+        */
+        static constexpr bool isWideRow = N * sizeof(Word) >= 512;
+        /**
+         * @brief peers (other lattices of the same row, column
+         * or block) of every lattice. Built once per size at
+         * first use, it is too big for a constant table.
+        */
+        struct Peers
+        {
+            unsigned short cells[S][P];
+            Peers();
+        };
+        static const Peers& peerTable();
+
+        /**
+         * @brief every digit is a candidate
+        */
+        static constexpr Word full = sizeof(Word) * 8 == N ? (Word)~(Word)0 :
+            (Word)(((Word)1 << (N % (sizeof(Word) * 8))) - 1);
+
+        /**
+         * @brief a state too big to copy at every search node
+         * is restored from a trail of the changes instead
+        */
+        static constexpr bool isTrailed = sizeof(State) > 4096;
+        /**
+         * @brief a mask as it was before a change
+        */
+        struct Change
+        {
+            unsigned short lattice;
+            Word mask;
+        };
+
+        /**
+         * @brief current state
+        */
+        State state;
+        /**
+         * @brief saved states, one per depth
+        */
+        std::vector<State> stack;
+        /**
+         * @brief changed masks and placed lattices, oldest
+         * first, when isTrailed
+        */
+        std::vector<Change> trail;
+        std::vector<unsigned short> placed;
+        /**
+         * @brief peers of every lattice
+        */
+        const unsigned short (*peers)[P] = peerTable().cells;
+        /**
+         * @brief empty lattices left with a single candidate,
+         * waiting for fill(). A lattice gets there once, when
+         * its mask narrows down to one bit.
+        */
+        unsigned short singles[S];
+        unsigned int singlesLen = 0;
+        /**
+         * @brief has an empty lattice run out of candidates?
+        */
+        bool isDead = false;
+        /**
+         * @brief the number of visited search nodes
+        */
+        unsigned long nodes = 0;
+        /**
+         * @brief counters of the rules, nullptr when off
+        */
+        SolveStats* stats = nullptr;
+        /**
+         * @brief search stops once this many solutions
+         * are found
+        */
+        unsigned long limit = 1;
+        /**
+         * @brief the number of solutions found
+        */
+        unsigned long solutions = 0;
+        /**
+         * @brief called with each solution, may be nullptr
+        */
+        const SolutionCallback* onSolution = nullptr;
+        /**
+         * @brief search gives up after this many nodes, as if
+         * a solution was found
+        */
+        unsigned long max_nodes = ~0UL;
+        /**
+         * @brief the largest i tried by i-excluding inside the
+         * search tree
+        */
+        unsigned int search_ie = 2;
+        /**
+         * @brief search gives up once the flag is set
+        */
+        const std::atomic<bool>* stopFlag = nullptr;
+
+        /**
+         * @brief keep a mask on the trail before it changes
+        */
+        void saveMask(unsigned int i)
+        {
+            if (isTrailed)
+                trail.push_back(Change{(unsigned short)i, state.mask[i]});
+        }
+        /**
+         * @brief queue an empty lattice whose mask just
+         * narrowed if it is left with a single candidate, mark
+         * the grid dead if with none
+        */
+        void checkLattice(unsigned int i)
+        {
+            const Word m = state.mask[i];
+            if (m == 0)
+                isDead = true;
+            else if ((m & (m - 1)) == 0)
+                singles[singlesLen++] = (unsigned short)i;
+        }
+        /**
+         * @brief rebuild the queue and the dead flag from
+         * scratch, after masks were set from outside
+        */
+        void scanSingles();
+        /**
+         * @brief undo the changes after a point of the trail
+        */
+        void undo(std::size_t trailSize, std::size_t placedSize);
+        /**
+         * @brief search recursively
+         * @return is the grid solved?
+        */
+        bool searchNode(unsigned int depth);
+        /**
+         * @brief count the solution state holds
+         * @return have limit solutions been found?
+        */
+        bool foundSolution();
+
+    public:
+        /**
+         * @brief naked singles, then i-excluding from 2
+         * up to max_ie, until nothing changes
+         * @return false if the grid turns out to be unsolvable
+        */
+        bool propagate(unsigned int max_ie);
+        /**
+         * @brief find the empty lattice with the fewest
+         * candidates
+         * @return its 1-d address, S if there is none
+        */
+        unsigned int branchLattice();
+        /**
+         * @brief write a digit into an empty lattice and
+         * remove it from the candidates of its peers
+         * @param i 1-d address
+         * @param digit digit to write
+        */
+        void place(unsigned int i, unsigned int digit);
+        /**
+         * @brief fill lattices that have a single candidate.
+         * Only lattices queued since the last call are
+         * visited, and fillings queue new ones until none is
+         * left.
+         * @return is update?
+        */
+        bool fill();
+        /**
+         * @brief i-excluding: if k <= ie lattices of a unit
+         * share k candidates (a naked subset), remove those
+         * candidates from the other lattices of the unit.
+         * Every subset size up to ie is found in one pass.
+         * @return is any update?
+        */
+        bool excluding(unsigned int ie);
+        /**
+         * @brief hidden subsets: if k <= ie digits of a unit
+         * can only go into the same k lattices, remove every
+         * other candidate from those lattices. ie = 1 finds
+         * hidden singles.
+         * @return is any update?
+        */
+        bool hiding(unsigned int ie);
+        /**
+         * @brief judge if an empty lattice has run out of
+         * candidates, a flag kept up to date by every change
+        */
+        bool hasDeadLattice() { return isDead; }
+        /**
+         * @brief is every lattice filled?
+        */
+        bool isCompleted() { return state.empty == 0; }
+        /**
+         * @brief load clues
+         * @param digits S digits, 0 represents "empty"
+         * @return false if the clues contradict
+        */
+        bool load(const char* digits);
+        /**
+         * @brief remove a candidate from an empty lattice,
+         * e.g. to ask whether a solution without it exists
+         * @param i 1-d address
+         * @param digit digit to remove
+        */
+        void exclude(unsigned int i, unsigned int digit)
+        {
+            const Word bit = (Word)1 << (digit - 1);
+            if ((state.mask[i] & bit) == 0)
+                return;
+            state.mask[i] &= ~bit;
+            checkLattice(i);
+        }
+        /**
+         * @brief empty a lattice of a grid that holds clues
+         * only, as if it was loaded without that clue
+         * @param i 1-d address of a filled lattice
+        */
+        void remove(unsigned int i);
+        /**
+         * @brief judge if a digit is forced into a lattice: it
+         * is its only candidate, or the lattice is the only
+         * place left for it in one of its units
+         * @param i 1-d address of an empty lattice
+         * @param digit digit to check
+        */
+        bool isForced(unsigned int i, unsigned int digit);
+        /**
+         * @brief run the rules without guessing
+         * @param max_ie the largest subset size tried, 1 for
+         * naked and hidden singles only
+         * @return do the rules alone complete the grid?
+        */
+        bool deduce(unsigned int max_ie)
+        { return propagate(max_ie) && state.empty == 0; }
+        /**
+         * @brief propagate and search
+         * @return is the grid solved?
+        */
+        bool solve();
+        /**
+         * @brief propagate and search every branch,
+         * counting solutions
+         * @param limit stop once this many are found
+         * @param onSolution called with each solution, may
+         * be nullptr
+         * @return the number of solutions, at most limit
+        */
+        unsigned long count(unsigned long limit,
+            const SolutionCallback* onSolution);
+        /**
+         * @brief look for any solution, with the rules used
+         * inside the search tree from the root on. Cheaper than
+         * solve() when a contradiction is expected.
+         * @param max_nodes give up after this many nodes
+         * @param max_ie the largest i tried by i-excluding
+         * inside the search tree, 1 for singles only
+         * @return is a solution found, or did it give up?
+        */
+        bool hasSolution(unsigned long max_nodes, unsigned int max_ie = 2);
+        /**
+         * @brief row-major lattices
+        */
+        const char* Lattices() { return state.lattices; }
+        /**
+         * @brief candidates of a lattice, bit k for digit k + 1
+        */
+        Word Candidates(unsigned int i) { return state.mask[i]; }
+        /**
+         * @brief copy the current state out, e.g. as the root
+         * of a subtree another grid searches
+        */
+        void saveState(State& saved) { saved = state; }
+        /**
+         * @brief continue from a saved state
+        */
+        void loadState(const State& saved)
+        {
+            state = saved;
+            trail.clear();
+            placed.clear();
+            scanSingles();
+        }
+        /**
+         * @brief let another thread cancel the search
+         * @param flag flag that is set to cancel, nullptr
+         * for none
+        */
+        void setStopFlag(const std::atomic<bool>* flag) { stopFlag = flag; }
+        /**
+         * @brief the number of search nodes visited by
+         * the last solve()
+        */
+        unsigned long Nodes() { return nodes; }
+        /**
+         * @brief count the work of the rules into stats,
+         * nullptr to stop counting
+        */
+        void setStats(SolveStats* stats) { this->stats = stats; }
+    };
+
+    template <unsigned int N, typename Word>
+    constexpr typename FixedGrid<N, Word>::Tables FixedGrid<N, Word>::tables;
+
+    template <unsigned int N, typename Word>
+    FixedGrid<N, Word>::Peers::Peers()
+    {
+        for (unsigned int i = 0; i < S; i++)
+        {
+            const unsigned int row = i / N;
+            const unsigned int col = i % N;
+            const unsigned int block_y = (row / B) * B;
+            const unsigned int block_x = (col / B) * B;
+            unsigned short* p = cells[i];
+            for (unsigned int k = 0; k < N; k++)
+            {
+                if (k != col)
+                    *p++ = row * N + k;
+                if (k != row)
+                    *p++ = k * N + col;
+            }
+            /* block lattices out of the row and the column */
+            for (unsigned int y = block_y; y < block_y + B; y++)
+                for (unsigned int x = block_x; x < block_x + B; x++)
+                    if (y != row && x != col)
+                        *p++ = y * N + x;
+        }
+    }
+
+    template <unsigned int N, typename Word>
+    const typename FixedGrid<N, Word>::Peers& FixedGrid<N, Word>::peerTable()
+    {
+        static const Peers table;
+        return table;
+    }
+
+    template <unsigned int N, typename Word>
+    void FixedGrid<N, Word>::scanSingles()
+    {
+        singlesLen = 0;
+        isDead = false;
+        for (unsigned int i = 0; i < S; i++)
+            if (state.lattices[i] == 0)
+                checkLattice(i);
+    }
+
+    template <unsigned int N, typename Word>
+    void FixedGrid<N, Word>::place(unsigned int i, unsigned int digit)
+    {
+        const Word bit = (Word)1 << (digit - 1);
+        if (isTrailed)
+        {
+            placed.push_back((unsigned short)i);
+            saveMask(i);
+        }
+        state.lattices[i] = digit;
+        state.mask[i] = 0;
+        state.empty--;
+        /* remove the digit from peers only */
+        const unsigned short* p = peers[i];
+        unsigned int updates = 0;
+        for (unsigned int k = 0; k < P; k++)
+        {
+            Word& m = state.mask[p[k]];
+            if ((m & bit) == 0)
+                continue;
+            saveMask(p[k]);
+            m &= ~bit;
+            updates++;
+            checkLattice(p[k]);
+        }
+        if (stats != nullptr)
+            stats->peer_updates += updates;
+    }
+
+    template <unsigned int N, typename Word>
+    bool FixedGrid<N, Word>::fill()
+    {
+        /* only lattices queued by place() or the rules can be filled */
+        bool isUpdated = false;
+        while (singlesLen > 0)
+        {
+            const unsigned int i = singles[--singlesLen];
+            const Word m = state.mask[i];
+            /* it may have been filled or lost its last candidate
+            meanwhile */
+            if (state.lattices[i] != 0 || m == 0)
+                continue;
+            place(i, lowBit(m) + 1);
+            isUpdated = true;
+            if (stats != nullptr)
+                stats->placements++;
+        }
+        if (stats != nullptr)
+        {
+            stats->fill_calls++;
+            stats->fill_passes += isUpdated;
+        }
+        return isUpdated;
+    }
+
+    template <unsigned int N, typename Word>
+    bool FixedGrid<N, Word>::excluding(unsigned int ie)
+    {
+        bool isAnyUpdate = false;
+        unsigned long* eliminations = nullptr;
+        if (stats != nullptr && ie < SolveStats::MAX_IE)
+        {
+            stats->excluding_calls[ie]++;
+            eliminations = stats->excluding_eliminations + ie;
+        }
+        unsigned int empties[N];
+        unsigned int members[N];
+        unsigned int chosen[N + 1];
+        Word unions[N + 1];
+        for (unsigned int u = 0; u < U; u++)
+        {
+            const unsigned short* cells = tables.unitCells[u];
+            unsigned int emptyLen = 0;
+            for (unsigned int k = 0; k < N; k++)
+                if (state.lattices[cells[k]] == 0)
+                    empties[emptyLen++] = cells[k];
+            /* a subset has no more than half of the empty
+            lattices, the rest is a hidden subset */
+            const unsigned int limit = ie < emptyLen / 2 ? ie : emptyLen / 2;
+            if (limit < 2)
+                continue;
+            unsigned int memberLen = 0;
+            for (unsigned int k = 0; k < emptyLen; k++)
+            {
+                const unsigned int bits = bitCount(state.mask[empties[k]]);
+                if (bits >= 2 && bits <= limit)
+                    members[memberLen++] = k;
+            }
+
+            /* enumerate unions of members, depth first */
+            unsigned int depth = 0;
+            chosen[0] = 0;
+            unions[0] = 0;
+            while (true)
+            {
+                if (chosen[depth] >= memberLen)
+                {
+                    if (depth == 0)
+                        break;
+                    depth--;
+                    chosen[depth]++;
+                    continue;
+                }
+                const Word un = unions[depth] | state.mask[empties[members[chosen[depth]]]];
+                const unsigned int bits = bitCount(un);
+                if (bits > limit)
+                {
+                    chosen[depth]++;
+                    continue;
+                }
+                if (bits == depth + 1)
+                {
+                    /* naked subset, eliminate its union from the
+                    other empty lattices */
+                    unsigned int c = 0;
+                    for (unsigned int k = 0; k < emptyLen; k++)
+                    {
+                        if (c <= depth && members[chosen[c]] == k)
+                        {
+                            c++;
+                            continue;
+                        }
+                        Word& m = state.mask[empties[k]];
+                        if ((m & un) != 0)
+                        {
+                            saveMask(empties[k]);
+                            if (eliminations != nullptr)
+                                *eliminations += bitCount((Word)(m & un));
+                            m &= ~un;
+                            checkLattice(empties[k]);
+                            isAnyUpdate = true;
+                        }
+                    }
+                    chosen[depth]++;
+                    continue;
+                }
+                unions[depth + 1] = un;
+                if (depth + 1 < limit)
+                {
+                    chosen[depth + 1] = chosen[depth] + 1;
+                    depth++;
+                }
+                else
+                    chosen[depth]++;
+            }
+        }
+        return isAnyUpdate;
+    }
+
+    template <unsigned int N, typename Word>
+    bool FixedGrid<N, Word>::hiding(unsigned int ie)
+    {
+        bool isAnyUpdate = false;
+        unsigned long* eliminations = nullptr;
+        if (stats != nullptr && ie < SolveStats::MAX_IE)
+        {
+            stats->hiding_calls[ie]++;
+            eliminations = stats->hiding_eliminations + ie;
+        }
+        /* where[d]: positions inside the unit where digit d + 1 can go */
+        Word where[N];
+        unsigned int members[N];
+        unsigned int chosen[N + 1];
+        Word unions[N + 1];
+        for (unsigned int u = 0; u < U; u++)
+        {
+            const unsigned short* cells = tables.unitCells[u];
+            if (ie == 1)
+            {
+                /* hidden singles: digits seen exactly once */
+                Word once = 0;
+                Word twice = 0;
+                for (unsigned int k = 0; k < N; k++)
+                {
+                    const Word m = state.mask[cells[k]];
+                    twice |= once & m;
+                    once |= m;
+                }
+                for (Word single = once & ~twice; single != 0; single &= single - 1)
+                {
+                    const Word bit = single & (~single + 1);
+                    for (unsigned int k = 0; k < N; k++)
+                    {
+                        Word& m = state.mask[cells[k]];
+                        if ((m & bit) == 0)
+                            continue;
+                        if (m != bit)
+                        {
+                            saveMask(cells[k]);
+                            if (eliminations != nullptr)
+                                *eliminations += bitCount((Word)(m & ~bit));
+                            m = bit;
+                            checkLattice(cells[k]);
+                            isAnyUpdate = true;
+                        }
+                        break;
+                    }
+                }
+                continue;
+            }
+            Word placed = 0;
+            for (unsigned int d = 0; d < N; d++)
+                where[d] = 0;
+            for (unsigned int k = 0; k < N; k++)
+            {
+                if (state.lattices[cells[k]] != 0)
+                {
+                    placed |= (Word)1 << (state.lattices[cells[k]] - 1);
+                    continue;
+                }
+                for (Word m = state.mask[cells[k]]; m != 0; m &= m - 1)
+                    where[lowBit(m)] |= (Word)1 << k;
+            }
+
+            unsigned int freeLen = 0;
+            unsigned int memberLen = 0;
+            for (unsigned int d = 0; d < N; d++)
+            {
+                if (placed & ((Word)1 << d))
+                    continue;
+                freeLen++;
+                const Word clue = where[d];
+                const unsigned int bits = bitCount(clue);
+                /* hidden single, no need to look for partners */
+                if (bits == 1)
+                {
+                    Word& m = state.mask[cells[lowBit(clue)]];
+                    if (m != ((Word)1 << d))
+                    {
+                        saveMask(cells[lowBit(clue)]);
+                        if (eliminations != nullptr)
+                            *eliminations += bitCount((Word)(m & ~((Word)1 << d)));
+                        m = (Word)1 << d;
+                        checkLattice(cells[lowBit(clue)]);
+                        isAnyUpdate = true;
+                    }
+                }
+                else if (bits >= 2 && bits <= ie)
+                    members[memberLen++] = d;
+            }
+            /* a hidden subset has no more than half of the free
+            digits, the rest is a naked subset */
+            const unsigned int limit = ie < freeLen / 2 ? ie : freeLen / 2;
+            if (limit < 2)
+                continue;
+
+            /* enumerate unions of the positions of members, depth
+            first: k digits whose positions add up to k lattices
+            are a hidden subset */
+            unsigned int depth = 0;
+            chosen[0] = 0;
+            unions[0] = 0;
+            while (true)
+            {
+                if (chosen[depth] >= memberLen)
+                {
+                    if (depth == 0)
+                        break;
+                    depth--;
+                    chosen[depth]++;
+                    continue;
+                }
+                const Word un = unions[depth] | where[members[chosen[depth]]];
+                const unsigned int bits = bitCount(un);
+                if (bits > limit)
+                {
+                    chosen[depth]++;
+                    continue;
+                }
+                if (bits == depth + 1)
+                {
+                    /* those positions hold nothing but those digits */
+                    Word digitMask = 0;
+                    for (unsigned int c = 0; c <= depth; c++)
+                        digitMask |= (Word)1 << members[chosen[c]];
+                    for (Word p = un; p != 0; p &= p - 1)
+                    {
+                        Word& m = state.mask[cells[lowBit(p)]];
+                        if ((m & ~digitMask) != 0)
+                        {
+                            saveMask(cells[lowBit(p)]);
+                            if (eliminations != nullptr)
+                                *eliminations += bitCount((Word)(m & ~digitMask));
+                            m &= digitMask;
+                            checkLattice(cells[lowBit(p)]);
+                            isAnyUpdate = true;
+                        }
+                    }
+                    chosen[depth]++;
+                    continue;
+                }
+                unions[depth + 1] = un;
+                if (depth + 1 < limit)
+                {
+                    chosen[depth + 1] = chosen[depth] + 1;
+                    depth++;
+                }
+                else
+                    chosen[depth]++;
+            }
+        }
+        return isAnyUpdate;
+    }
+
+    template <unsigned int N, typename Word>
+    bool FixedGrid<N, Word>::load(const char* digits)
+    {
+        const MaskKernels& kernels = maskKernels();
+        trail.clear();
+        placed.clear();
+        if (stats != nullptr)
+            stats->initialize_mask++;
+        /* digits placed in every unit, clues repeating one
+        of them can not be loaded */
+        Word units[U] = {};
+        state.empty = S;
+        for (unsigned int i = 0; i < S; i++)
+        {
+            const unsigned int digit = (unsigned char)digits[i];
+            state.lattices[i] = digit;
+            if (digit == 0)
+                continue;
+            if (digit > N)
+                return false;
+            const Word bit = (Word)1 << (digit - 1);
+            const unsigned short* unit = tables.latticeUnits[i];
+            if (((units[unit[0]] | units[unit[1]] | units[unit[2]]) & bit) != 0)
+                return false;
+            units[unit[0]] |= bit;
+            units[unit[1]] |= bit;
+            units[unit[2]] |= bit;
+            state.empty--;
+        }
+        for (unsigned int u = 0; u < U; u++)
+            units[u] = full & ~units[u];
+
+        /* narrow rows are cheaper in one loop than in kernel calls */
+        for (unsigned int row = 0; row < N && !isWideRow; row++)
+        {
+            Word* rowMask = state.mask + row * N;
+            const Word* blocks = units + 2 * N + row / B * B;
+            for (unsigned int col = 0; col < N; col++)
+                rowMask[col] = units[N + col] & units[row] & blocks[col / B];
+        }
+        /* a row of lattices sees the column masks side by side and
+        shares the block masks with its block row, so every row is a
+        copy of that line and one vector AND with the row mask */
+        Word line[N];
+        for (unsigned int row = 0; row < N && isWideRow; row++)
+        {
+            if (row % B == 0)
+            {
+                std::memcpy(line, units + N, sizeof(line));
+                for (unsigned int bx = 0; bx < B; bx++)
+                    kernels.andPattern((unsigned char*)(line + bx * B),
+                        (const unsigned char*)(units + 2 * N + row + bx),
+                        sizeof(Word), B);
+            }
+            Word* rowMask = state.mask + row * N;
+            std::memcpy(rowMask, line, sizeof(line));
+            kernels.andPattern((unsigned char*)rowMask,
+                (const unsigned char*)(units + row), sizeof(Word), N);
+        }
+        for (unsigned int i = 0; i < S; i++)
+            if (state.lattices[i] != 0)
+                state.mask[i] = 0;
+
+        /* queue lattices that can be filled */
+        scanSingles();
+        return true;
+    }
+
+    template <unsigned int N, typename Word>
+    void FixedGrid<N, Word>::remove(unsigned int i)
+    {
+        const Word bit = (Word)1 << (state.lattices[i] - 1);
+        state.lattices[i] = 0;
+        state.empty++;
+        /* digits placed in every unit, in one pass */
+        Word digits[U] = {};
+        for (unsigned int c = 0; c < S; c++)
+            if (state.lattices[c] != 0)
+            {
+                const Word digit = (Word)1 << (state.lattices[c] - 1);
+                for (unsigned int u = 0; u < 3; u++)
+                    digits[tables.latticeUnits[c][u]] |= digit;
+            }
+        const unsigned short* units = tables.latticeUnits[i];
+        state.mask[i] = full & ~(digits[units[0]] | digits[units[1]] | digits[units[2]]);
+        /* peers get the digit back unless another unit of
+        theirs still holds it */
+        for (unsigned int u = 0; u < 3; u++)
+        {
+            const unsigned short* cells = tables.unitCells[units[u]];
+            for (unsigned int k = 0; k < N; k++)
+            {
+                const unsigned short* peer = tables.latticeUnits[cells[k]];
+                if (state.lattices[cells[k]] == 0 &&
+                    ((digits[peer[0]] | digits[peer[1]] | digits[peer[2]]) & bit) == 0)
+                    state.mask[cells[k]] |= bit;
+            }
+        }
+        /* masks grew, queued and dead lattices may be stale */
+        scanSingles();
+    }
+
+    template <unsigned int N, typename Word>
+    bool FixedGrid<N, Word>::isForced(unsigned int i, unsigned int digit)
+    {
+        const Word bit = (Word)1 << (digit - 1);
+        if (state.mask[i] == bit)
+            return true;
+        for (unsigned int u = 0; u < 3; u++)
+        {
+            const unsigned short* cells = tables.unitCells[tables.latticeUnits[i][u]];
+            bool isElsewhere = false;
+            for (unsigned int k = 0; k < N && !isElsewhere; k++)
+                isElsewhere = cells[k] != i && state.lattices[cells[k]] == 0 &&
+                    (state.mask[cells[k]] & bit) != 0;
+            if (!isElsewhere)
+                return true;
+        }
+        return false;
+    }
+
+    template <unsigned int N, typename Word>
+    bool FixedGrid<N, Word>::propagate(unsigned int max_ie)
+    {
+        unsigned int ie = 2;
+        while (true)
+        {
+            fill();
+            if (state.empty == 0)
+                return true;
+            if (hasDeadLattice())
+                return false;
+            if (hiding(1))
+            {
+                ie = 2;
+                continue;
+            }
+            if (ie > max_ie || ie > N)
+                return true;
+            if (excluding(ie) || hiding(ie))
+            {
+                ie = 2;
+                continue;
+            }
+            ie++;
+        }
+    }
+
+    template <unsigned int N, typename Word>
+    bool FixedGrid<N, Word>::searchNode(unsigned int depth)
+    {
+        if (++nodes > max_nodes)
+            return true;
+        if (stopFlag != nullptr && stopFlag->load(std::memory_order_relaxed))
+            return false;
+        if (!propagate(search_ie))
+            return false;
+        if (state.empty == 0)
+            return foundSolution();
+
+        const unsigned int lattice = branchLattice();
+        const std::size_t trailSize = trail.size();
+        const std::size_t placedSize = placed.size();
+        if (!isTrailed)
+        {
+            if (stack.size() <= depth)
+                stack.resize(depth + 1);
+            stack[depth] = state;
+        }
+        for (Word m = state.mask[lattice]; m != 0; m &= m - 1)
+        {
+            place(lattice, lowBit(m) + 1);
+            if (searchNode(depth + 1))
+                return true;
+            if (stopFlag != nullptr &&
+                stopFlag->load(std::memory_order_relaxed))
+                return false;
+            if (isTrailed)
+                undo(trailSize, placedSize);
+            else
+                state = stack[depth];
+            /* the node propagated before branching, so nothing
+            was queued or dead */
+            singlesLen = 0;
+            isDead = false;
+        }
+        return false;
+    }
+
+    template <unsigned int N, typename Word>
+    void FixedGrid<N, Word>::undo(std::size_t trailSize, std::size_t placedSize)
+    {
+        while (trail.size() > trailSize)
+        {
+            state.mask[trail.back().lattice] = trail.back().mask;
+            trail.pop_back();
+        }
+        while (placed.size() > placedSize)
+        {
+            state.lattices[placed.back()] = 0;
+            state.empty++;
+            placed.pop_back();
+        }
+    }
+
+    template <unsigned int N, typename Word>
+    unsigned int FixedGrid<N, Word>::branchLattice()
+    {
+        unsigned int lattice = S;
+        unsigned int bestCount = N + 1;
+        /* a lattice with 2 candidates is the best we can get */
+        for (unsigned int i = 0; i < S && bestCount > 2; i++)
+        {
+            if (state.lattices[i] != 0)
+                continue;
+            const unsigned int count = bitCount(state.mask[i]);
+            if (count < bestCount)
+            {
+                lattice = i;
+                bestCount = count;
+            }
+        }
+        return lattice;
+    }
+
+    template <unsigned int N, typename Word>
+    bool FixedGrid<N, Word>::foundSolution()
+    {
+        solutions++;
+        if (onSolution != nullptr)
+            (*onSolution)(state.lattices);
+        return solutions >= limit;
+    }
+
+    template <unsigned int N, typename Word>
+    bool FixedGrid<N, Word>::solve()
+    { return count(1, nullptr) == 1; }
+
+    template <unsigned int N, typename Word>
+    bool FixedGrid<N, Word>::hasSolution(unsigned long max_nodes,
+        unsigned int max_ie)
+    {
+        nodes = 0;
+        solutions = 0;
+        limit = 1;
+        onSolution = nullptr;
+        this->max_nodes = max_nodes;
+        search_ie = max_ie;
+        const bool isFound = searchNode(0);
+        search_ie = 2;
+        return isFound;
+    }
+
+    template <unsigned int N, typename Word>
+    unsigned long FixedGrid<N, Word>::count(unsigned long limit,
+        const SolutionCallback* onSolution)
+    {
+        nodes = 1;
+        solutions = 0;
+        max_nodes = ~0UL;
+        search_ie = 2;
+        this->limit = limit;
+        this->onSolution = onSolution;
+        if (!propagate(N))
+            return 0;
+        if (state.empty == 0)
+            foundSolution();
+        else
+            searchNode(0);
+        return solutions;
+    }
+
+    /**
+     * @brief count the solutions of a grid with a FixedGrid
+     * specialization. Its buffers are kept per thread and
+     * reused.
+     * @param grid grid loaded with clues, holds the solution
+     * (with its mask reset) if limit is 1 and there is one
+     * @param limit stop once this many are found
+     * @param onSolution called with each solution, may be
+     * nullptr
+     * @return the number of solutions, at most limit
+    */
+    template <unsigned int N, typename Word>
+    static unsigned long countFixed(Grid& grid, unsigned long limit,
+        const SolutionCallback* onSolution)
+    {
+        static thread_local std::vector<FixedGrid<N, Word>> fixed(1);
+        fixed[0].setStats(grid.Stats());
+        if (!fixed[0].load(grid.Lattices()))
+            return 0;
+        const unsigned long found = fixed[0].count(limit, onSolution);
+        if (grid.Stats() != nullptr)
+            grid.Stats()->search_nodes += fixed[0].Nodes();
+        /* a search limited to one stops on the solution */
+        if (limit == 1 && found == 1)
+            grid.load(fixed[0].Lattices());
+        return found;
+    }
+
+    /**
+     * @brief solve a grid with a FixedGrid specialization
+     * @param grid grid loaded with clues, holds the solution
+     * on success (with its mask reset)
+     * @return is the grid solved?
+    */
+    template <unsigned int N, typename Word>
+    static bool solveFixed(Grid& grid)
+    { return countFixed<N, Word>(grid, 1, nullptr) == 1; }
+
+    /**
+     * @brief a FixedGrid specialization, passed by value to
+     * the callable of dispatchFixed()
+    */
+    template <unsigned int Length, typename W>
+    struct FixedSize
+    {
+        static constexpr unsigned int N = Length;
+        typedef W Word;
+    };
+
+    /**
+     * @brief call the FixedGrid specialization that fits a grid
+     * size length. This is the only list of specializations,
+     * every *Dispatch() goes through it.
+     * @param length grid size length
+     * @param fixed generic callable, called with a FixedSize
+     * @param fallback callable without arguments, called for a
+     * size with no specialization
+     * @return what the called one returns
+    */
+    template <typename Fixed, typename Fallback>
+    static auto dispatchFixed(unsigned int length, Fixed&& fixed,
+        Fallback&& fallback) -> decltype(fallback())
+    {
+        switch (length)
+        {
+        case 4:
+            return fixed(FixedSize<4, std::uint16_t>());
+        case 9:
+            return fixed(FixedSize<9, std::uint16_t>());
+        case 16:
+            return fixed(FixedSize<16, std::uint16_t>());
+        case 25:
+            return fixed(FixedSize<25, std::uint32_t>());
+        case 36:
+            return fixed(FixedSize<36, std::uint64_t>());
+        case 49:
+            return fixed(FixedSize<49, std::uint64_t>());
+        case 64:
+            return fixed(FixedSize<64, std::uint64_t>());
+#ifdef __SIZEOF_INT128__
+        case 81:
+            return fixed(FixedSize<81, unsigned __int128>());
+        case 100:
+            return fixed(FixedSize<100, unsigned __int128>());
+#endif
+        default:
+            return fallback();
+        }
+    }
+
+    /**
+     * @brief count the solutions of a grid with the FixedGrid
+     * specialization that fits its size, or with the generic
+     * Grid rules if there is none.
+     * @param grid grid loaded with clues, holds the solution
+     * if limit is 1 and there is one
+     * @param searcher searcher used by the generic fallback
+     * @param limit stop once this many are found
+     * @param onSolution called with each solution, may be
+     * nullptr
+     * @return the number of solutions, at most limit
+    */
+    static unsigned long countDispatch(Grid& grid, Searcher& searcher,
+        unsigned long limit, const SolutionCallback* onSolution);
+
+    /**
+     * @brief solve a grid with the FixedGrid specialization
+     * that fits its size, or with the generic Grid rules
+     * if there is none.
+     * @param grid grid loaded with clues
+     * @param searcher searcher used by the generic fallback
+     * @return is the grid solved?
+    */
+    static bool solveDispatch(Grid& grid, Searcher& searcher)
+    { return countDispatch(grid, searcher, 1, nullptr) == 1; }
+
+    static unsigned long countDispatch(Grid& grid, Searcher& searcher,
+        unsigned long limit, const SolutionCallback* onSolution)
+    {
+        return dispatchFixed(grid.Length(), [&](auto size)
+        {
+            typedef decltype(size) Size;
+            return countFixed<Size::N, typename Size::Word>(grid, limit,
+                onSolution);
+        },
+        [&]() { return countGrid(grid, searcher, limit, onSolution); });
+    }
+}
\ No newline at end of file
@@ -0,0 +1,4 @@
+#ifndef FIXEDGRID_H
+#define FIXEDGRID_H
+#include "FixedGrid.cxx"
+#endif
\ No newline at end of file
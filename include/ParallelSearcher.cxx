@@ -0,0 +1,337 @@
+/*******************************************
+ * @title   Parallel searcher
+ * @brief   split the search tree of one
+ * puzzle across threads
+ * @author  Bin Qu
+ * @date    2026.10.17
+ * @copyright   You can edit and remodify
+ * this file.
+*******************************************/
+
+#include "element.h"
+#include "FixedGrid.h"
+#include "solver.h"
+#include "ThreadPool.h"
+
+#include <atomic>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <vector>
+
+namespace sds
+{
+    /**
+     * Backtracking search for a single large puzzle.
+     * The top of the tree is expanded on the calling
+     * thread by the candidate digits of branching lattices,
+     * then every subtree is searched by a worker with its
+     * own Grid. Workers share nothing mutable but a stop
+     * flag, which the first worker to find a solution sets.
+    */
+    class ParallelSearcher
+    {
+    private:
+        /**
+         * @brief saved state of a subtree root
+        */
+        struct Subtree
+        {
+            std::vector<char> lattices;
+            std::vector<byte> mask;
+        };
+        /**
+         * @brief the number of workers
+        */
+        unsigned int threads;
+        /**
+         * @brief the largest i tried by i-excluding
+         * inside the search tree
+        */
+        unsigned int max_ie;
+        /**
+         * @brief subtrees wanted per worker, so that
+         * stealing can balance uneven subtrees
+        */
+        const unsigned int subtrees_per_thread = 8;
+        /**
+         * @brief the number of visited search nodes
+        */
+        unsigned long nodes = 0;
+
+        /**
+         * @brief save the state of a grid as a subtree
+        */
+        static void saveSubtree(Grid& grid, Subtree& subtree);
+        /**
+         * @brief expand the top of the tree into subtrees
+         * @param grid propagated grid, holds the solution
+         * if one is met during expansion
+         * @param frontier output subtrees
+         * @param workers the number of workers the subtrees
+         * are spread over
+         * @return is the grid solved during expansion?
+        */
+        bool expand(Grid& grid, std::deque<Subtree>& frontier,
+            unsigned int workers);
+
+    public:
+        /**
+         * @brief solve the grid, leaving the solution
+         * in it if there is any.
+         * @param grid grid whose mask is initialized
+         * @return is the grid solved?
+        */
+        bool search(Grid& grid);
+        /**
+         * @brief the number of search nodes visited by
+         * the last search()
+        */
+        unsigned long Nodes() { return nodes; }
+        /**
+         * @brief constructor
+         * @param threads the number of workers, 0 for one
+         * per hardware thread
+         * @param max_ie the largest i tried by i-excluding
+         * after each guess
+        */
+        ParallelSearcher(unsigned int threads, unsigned int max_ie = 2)
+            : threads(threads), max_ie(max_ie) { }
+    };
+
+    /**
+     * @brief solve a grid by splitting its search tree over
+     * workers the way ParallelSearcher does, each searching
+     * its subtrees with a FixedGrid specialization
+     * @param grid grid loaded with clues, holds the solution
+     * on success (with its mask reset)
+     * @param threads the number of workers, 0 for one per
+     * hardware thread
+     * @param nodes receives the number of search nodes
+     * @return is the grid solved?
+    */
+    template <unsigned int N, typename Word>
+    static bool parallelFixed(Grid& grid, unsigned int threads,
+        unsigned long& nodes);
+
+    /**
+     * @brief solve a grid on several threads with the FixedGrid
+     * specialization that fits its size, or with
+     * ParallelSearcher on the generic Grid if there is none.
+     * @param grid grid loaded with clues
+     * @param threads the number of workers, 0 for one per
+     * hardware thread
+     * @param nodes receives the number of search nodes
+     * @return is the grid solved?
+    */
+    static bool parallelDispatch(Grid& grid, unsigned int threads,
+        unsigned long& nodes);
+
+    void ParallelSearcher::saveSubtree(Grid& grid, Subtree& subtree)
+    {
+        subtree.lattices.resize(grid.LatticeBytes());
+        subtree.mask.resize(grid.MaskBytes());
+        grid.saveState(subtree.lattices.data(), subtree.mask.data());
+    }
+
+    bool ParallelSearcher::expand(Grid& grid, std::deque<Subtree>& frontier,
+        unsigned int workers)
+    {
+        const unsigned int length = grid.Length();
+        const unsigned int target = workers * subtrees_per_thread;
+        frontier.clear();
+        frontier.emplace_back();
+        saveSubtree(grid, frontier.back());
+
+        /* breadth first, so subtrees have similar depth */
+        Subtree parent;
+        while (!frontier.empty() && frontier.size() < target)
+        {
+            parent = std::move(frontier.front());
+            frontier.pop_front();
+            grid.loadState(parent.lattices.data(), parent.mask.data());
+            const unsigned int lattice = Searcher::pickLattice(grid);
+            for (unsigned int digit = 1; digit <= length; digit++)
+            {
+                grid.loadState(parent.lattices.data(), parent.mask.data());
+                if (!grid(lattice / length, lattice % length, digit))
+                    continue;
+                grid.place(lattice, digit);
+                nodes++;
+                if (!propagate(grid, max_ie))
+                    continue;
+                if (grid.isCompleted())
+                    return true;
+                frontier.emplace_back();
+                saveSubtree(grid, frontier.back());
+            }
+        }
+        return false;
+    }
+
+    bool ParallelSearcher::search(Grid& grid)
+    {
+        nodes = 1;
+        if (!propagate(grid, max_ie))
+            return false;
+        if (grid.isCompleted())
+            return true;
+
+        /* the pool resolves 0 threads to one per hardware thread */
+        ThreadPool pool(threads);
+        const unsigned int workers = pool.Size();
+        std::deque<Subtree> frontier;
+        if (expand(grid, frontier, workers))
+            return true;
+        if (frontier.empty())
+            return false;
+
+        /* per-worker grids and searchers */
+        std::vector<std::unique_ptr<Grid>> grids;
+        std::vector<Searcher> searchers(workers, Searcher(max_ie));
+        std::atomic<bool> isFound(false);
+        for (unsigned int i = 0; i < workers; i++)
+        {
+            grids.emplace_back(new Grid(grid.Length(), grid.BlockLength()));
+            grids[i]->setVerbose(false);
+            searchers[i].setStopFlag(&isFound);
+        }
+        std::vector<unsigned long> workerNodes(workers, 0);
+
+        /* the winner alone writes the solution */
+        Subtree solution;
+        for (unsigned int k = 0; k < frontier.size(); k++)
+            pool.submit([&, k](unsigned int worker)
+            {
+                if (isFound.load(std::memory_order_relaxed))
+                    return;
+                Grid& local = *grids[worker];
+                local.loadState(frontier[k].lattices.data(),
+                    frontier[k].mask.data());
+                bool isSolved = searchers[worker].search(local);
+                workerNodes[worker] += searchers[worker].Nodes();
+                bool expected = false;
+                if (isSolved && isFound.compare_exchange_strong(expected, true))
+                    saveSubtree(local, solution);
+            });
+        pool.wait();
+
+        for (unsigned int i = 0; i < workers; i++)
+            nodes += workerNodes[i];
+        if (!isFound)
+            return false;
+        grid.loadState(solution.lattices.data(), solution.mask.data());
+        return true;
+    }
+
+    template <unsigned int N, typename Word>
+    static bool parallelFixed(Grid& grid, unsigned int threads,
+        unsigned long& nodes)
+    {
+        typedef FixedGrid<N, Word> Fixed;
+        typedef typename Fixed::State State;
+        const unsigned int subtrees_per_thread = 8;
+        /* states of big grids are too large for the stack */
+        std::unique_ptr<Fixed> root(new Fixed());
+        nodes = 1;
+        if (!root->load(grid.Lattices()) || !root->propagate(N))
+            return false;
+        if (root->isCompleted())
+        {
+            grid.load(root->Lattices());
+            return true;
+        }
+
+        /* the pool resolves 0 threads to one per hardware thread */
+        ThreadPool pool(threads);
+        const unsigned int workers = pool.Size();
+        const unsigned int target = workers * subtrees_per_thread;
+        std::deque<State> frontier(1);
+        root->saveState(frontier.back());
+
+        /* breadth first, so subtrees have similar depth */
+        std::unique_ptr<State> parent(new State());
+        while (!frontier.empty() && frontier.size() < target)
+        {
+            *parent = frontier.front();
+            frontier.pop_front();
+            root->loadState(*parent);
+            const unsigned int lattice = root->branchLattice();
+            for (Word m = root->Candidates(lattice); m != 0; m &= m - 1)
+            {
+                root->loadState(*parent);
+                root->place(lattice, lowBit(m) + 1);
+                nodes++;
+                if (!root->propagate(2))
+                    continue;
+                if (root->isCompleted())
+                {
+                    grid.load(root->Lattices());
+                    return true;
+                }
+                frontier.emplace_back();
+                root->saveState(frontier.back());
+            }
+        }
+        if (frontier.empty())
+            return false;
+
+        /* per-worker grids */
+        std::vector<std::unique_ptr<Fixed>> grids;
+        std::atomic<bool> isFound(false);
+        for (unsigned int i = 0; i < workers; i++)
+        {
+            grids.emplace_back(new Fixed());
+            grids[i]->setStopFlag(&isFound);
+        }
+        std::vector<unsigned long> workerNodes(workers, 0);
+
+        /* the winner alone writes the solution */
+        std::vector<char> solution(Fixed::S);
+        for (unsigned int k = 0; k < frontier.size(); k++)
+            pool.submit([&, k](unsigned int worker)
+            {
+                if (isFound.load(std::memory_order_relaxed))
+                    return;
+                Fixed& local = *grids[worker];
+                local.loadState(frontier[k]);
+                bool isSolved = local.hasSolution(~0UL);
+                workerNodes[worker] += local.Nodes();
+                bool expected = false;
+                if (isSolved && isFound.compare_exchange_strong(expected, true))
+                    std::memcpy(solution.data(), local.Lattices(), Fixed::S);
+            });
+        pool.wait();
+
+        for (unsigned int i = 0; i < workers; i++)
+            nodes += workerNodes[i];
+        if (!isFound)
+            return false;
+        grid.load(solution.data());
+        return true;
+    }
+
+    static bool parallelDispatch(Grid& grid, unsigned int threads,
+        unsigned long& nodes)
+    {
+        return dispatchFixed(grid.Length(), [&](auto size)
+        {
+            typedef decltype(size) Size;
+            return parallelFixed<Size::N, typename Size::Word>(grid, threads,
+                nodes);
+        },
+        [&]()
+        {
+            grid.initializeMask();
+            nodes = 1;
+            if (!propagate(grid, grid.Length()))
+                return false;
+            if (grid.isCompleted())
+                return true;
+            ParallelSearcher searcher(threads);
+            const bool isSolved = searcher.search(grid);
+            nodes = searcher.Nodes();
+            return isSolved;
+        });
+    }
+}
\ No newline at end of file
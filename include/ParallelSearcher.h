@@ -0,0 +1,4 @@
+#ifndef PARALLELSEARCHER_H
+#define PARALLELSEARCHER_H
+#include "ParallelSearcher.cxx"
+#endif
\ No newline at end of file
@@ -0,0 +1,428 @@
+/*******************************************
+ * @title   Puzzle reader
+ * @brief   stream many sudoku puzzles out of
+ * one file
+ * @author  Bin Qu
+ * @date    2026.10.17
+ * @copyright   You can edit and remodify
+ * this file.
+*******************************************/
+
+#include "FileHandler.h"
+#include "simd.h"
+
+#include <cctype>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace sds
+{
+    /**
+     * Layout of a puzzle in a batch file
+    */
+    enum PuzzleFormat
+    {
+        /* comma separated rows, puzzles separated by blank lines */
+        fmt_csv,
+        /* one puzzle per line, e.g. 81 chars for 9x9: '1'-'9'
+        then 'A'... for 10 and up, '.' or '0' for empty */
+        fmt_line,
+        /* one 16x16 puzzle per line in hexadecimal: '0'-'F'
+        for 1-16, '.' for empty */
+        fmt_hex,
+        /* one puzzle per line in letters: 'A' for 1, '.' or
+        '0' for empty */
+        fmt_letters
+    };
+
+    /**
+     * @brief judge if a square grid size is supported
+     * @param size the number of lattices
+     * @param length output grid size length
+    */
+    static bool isGridSize(std::size_t size, unsigned int& length);
+
+    /**
+     * @brief parse a one-line puzzle of 16, 81, 256 or 625
+     * symbols, detecting its alphabet: a 16x16 line with '.'
+     * and '0' or 'A'-'F' but no letter past 'F' is
+     * hexadecimal, a line of letters without '1'-'9' is
+     * fmt_letters, anything else is fmt_line. Letters are
+     * case-insensitive.
+     * @param line first symbol, surrounding spaces allowed
+     * @param len the number of chars
+     * @param digits output buffer, row-major, 0 for empty
+     * @param length output grid size length
+     * @param format output alphabet
+     * @return false if the line is not a puzzle
+    */
+    static bool parseLinePuzzle(const char* line, std::size_t len,
+        std::vector<char>& digits, unsigned int& length,
+        PuzzleFormat& format);
+
+    /**
+     * @brief the symbol of a digit in a one-line format
+     * @param digit 0 for empty
+    */
+    static inline char lineSymbol(int digit, PuzzleFormat format);
+
+    /**
+     * Reader that yields the puzzles of a batch file
+     * one at a time. A file is mapped and parsed in place,
+     * stdin is read in chunks, so inputs of any size run
+     * in constant memory.
+    */
+    class PuzzleReader
+    {
+    private:
+        /**
+         * @brief input file, mapped
+        */
+        std::unique_ptr<MappedFile> file;
+        /**
+         * @brief input stream when reading stdin
+        */
+        std::FILE* stream;
+        /**
+         * @brief chunk of stdin being parsed
+        */
+        std::vector<char> chunk;
+        /**
+         * @brief bytes being parsed, the mapped file
+         * or the chunk
+        */
+        const char* data;
+        std::size_t size;
+        /**
+         * @brief offset of the next line in data
+        */
+        std::size_t pos;
+        /**
+         * @brief current line, without "\r\n"
+        */
+        const char* line;
+        std::size_t lineLen;
+        /**
+         * @brief line number of current line
+        */
+        unsigned long lineNo = 0;
+        /**
+         * @brief the number of rows of the csv grid
+         * being read
+        */
+        unsigned int csvRows = 0;
+
+        /**
+         * @brief keep the unparsed tail of the chunk and
+         * read more of the stream after it
+         * @return false if nothing more could be read
+        */
+        bool refill();
+        /**
+         * @brief read a line and strip '\r'
+         * @return false on EOF
+        */
+        bool readLine();
+        /**
+         * @brief judge if current line has only spaces
+        */
+        bool isBlankLine();
+        /**
+         * @brief append the digits of a csv row
+         * @param digits output buffer
+         * @return the number of digits in the row,
+         * 0 if the row is invalid
+        */
+        unsigned int parseCSVRow(std::vector<char>& digits);
+        /**
+         * @brief judge if current line is a one-line puzzle
+         * rather than a csv row: no separator between its
+         * first and last symbol
+        */
+        bool isLinePuzzle();
+
+    public:
+        /**
+         * @brief the number of records skipped as
+         * malformed
+        */
+        unsigned long skipped = 0;
+        /**
+         * @brief is the input available?
+        */
+        bool isOpen() { return stream != nullptr ||
+            (file && file->isOpen()); }
+        /**
+         * @brief read the next puzzle
+         * @param digits output buffer, row-major, 0 for empty
+         * @param length output grid size length
+         * @param format output format of the puzzle
+         * @return false when input is exhausted
+        */
+        bool next(std::vector<char>& digits, unsigned int& length,
+            PuzzleFormat& format);
+        /**
+         * @brief constructor that opens the input
+         * @param filename file path, "-" for stdin
+        */
+        PuzzleReader(const std::string& filename);
+    };
+
+    PuzzleReader::PuzzleReader(const std::string& filename)
+        : stream(nullptr), data(nullptr), size(0), pos(0),
+        line(nullptr), lineLen(0)
+    {
+        if (filename == "-")
+        {
+            stream = stdin;
+            chunk.resize(1 << 20);
+            data = chunk.data();
+            return;
+        }
+        file.reset(new MappedFile(filename));
+        data = file->Data();
+        size = file->Size();
+    }
+
+    bool PuzzleReader::refill()
+    {
+        if (stream == nullptr)
+            return false;
+        const std::size_t rest = size - pos;
+        /* a line longer than the chunk: grow it */
+        if (rest == chunk.size())
+            chunk.resize(2 * chunk.size());
+        std::memmove(chunk.data(), chunk.data() + pos, rest);
+        const std::size_t n = std::fread(chunk.data() + rest, 1,
+            chunk.size() - rest, stream);
+        data = chunk.data();
+        size = rest + n;
+        pos = 0;
+        return n > 0;
+    }
+
+    bool PuzzleReader::readLine()
+    {
+        const char* lineEnd;
+        while (true)
+        {
+            line = data + pos;
+            lineEnd = (const char*)std::memchr(line, '\n', size - pos);
+            if (lineEnd != nullptr)
+            {
+                pos = lineEnd - data + 1;
+                break;
+            }
+            if (refill())
+                continue;
+            /* the last line may not end with '\n' */
+            if (pos == size)
+                return false;
+            lineEnd = data + size;
+            pos = size;
+            break;
+        }
+        lineNo++;
+        lineLen = lineEnd - line;
+        if (lineLen > 0 && line[lineLen - 1] == '\r')
+            lineLen--;
+        return true;
+    }
+
+    bool PuzzleReader::isBlankLine()
+    {
+        for (std::size_t i = 0; i < lineLen; i++)
+            if (line[i] != ' ' && line[i] != '\t')
+                return false;
+        return true;
+    }
+
+    bool PuzzleReader::isLinePuzzle()
+    {
+        std::size_t start = 0;
+        std::size_t end = lineLen;
+        while (start < end && std::isspace((unsigned char)line[start]))
+            start++;
+        while (end > start && std::isspace((unsigned char)line[end - 1]))
+            end--;
+        for (std::size_t i = start; i < end; i++)
+            if (isSeparator(line[i]))
+                return false;
+        return true;
+    }
+
+    unsigned int PuzzleReader::parseCSVRow(std::vector<char>& digits)
+    {
+        const TextKernels& kernels = textKernels();
+        const char* p = line;
+        const char* end = line + lineLen;
+        unsigned int count = 0;
+        while ((p = kernels.skipSeparators(p, end)) != end)
+        {
+            int value = 0;
+            if (*p < '0' || *p > '9')
+                return 0;
+            while (p < end && *p >= '0' && *p <= '9' && value <= 100)
+                value = value * 10 + (*p++ - '0');
+            if (value > 100 || (p < end && !isSeparator(*p)))
+                return 0;
+            digits.push_back((char)value);
+            count++;
+        }
+        return count;
+    }
+
+    static bool isGridSize(std::size_t size, unsigned int& length)
+    {
+        if (size > 100 * 100)
+            return false;
+        length = (unsigned int)std::sqrt(size);
+        unsigned int blocklength = (unsigned int)std::sqrt(length);
+        return length * length == size &&
+            blocklength * blocklength == length &&
+            length >= 4 && length <= 100;
+    }
+
+    static bool parseLinePuzzle(const char* line, std::size_t len,
+        std::vector<char>& digits, unsigned int& length,
+        PuzzleFormat& format)
+    {
+        std::size_t start = 0;
+        std::size_t end = len;
+        while (start < end && std::isspace((unsigned char)line[start]))
+            start++;
+        while (end > start && std::isspace((unsigned char)line[end - 1]))
+            end--;
+        /* 25x25 is the largest grid a letter alphabet covers */
+        if (!isGridSize(end - start, length) || length > 25)
+            return false;
+        bool hasDot = false;
+        bool hasZero = false;
+        bool hasDigit = false;
+        bool hasHexLetter = false;
+        bool hasOtherLetter = false;
+        for (std::size_t i = start; i < end; i++)
+        {
+            const char c = std::toupper((unsigned char)line[i]);
+            hasDot |= c == '.';
+            hasZero |= c == '0';
+            hasDigit |= c >= '1' && c <= '9';
+            hasHexLetter |= c >= 'A' && c <= 'F';
+            hasOtherLetter |= c > 'F' && c <= 'Z';
+        }
+        /* 'G' is 16 in fmt_line, while a hexadecimal line
+        may miss '0' when 1 is no clue */
+        if (length == 16 && hasDot && (hasZero || hasHexLetter) &&
+            !hasOtherLetter)
+            format = PuzzleFormat::fmt_hex;
+        else if (length > 9 && !hasDigit)
+            format = PuzzleFormat::fmt_letters;
+        else
+            format = PuzzleFormat::fmt_line;
+
+        digits.clear();
+        for (std::size_t i = start; i < end; i++)
+        {
+            const char c = std::toupper((unsigned char)line[i]);
+            int value;
+            if (c == '.')
+                value = 0;
+            else if (c >= '0' && c <= '9')
+                value = format == PuzzleFormat::fmt_hex ? c - '0' + 1 :
+                    (format == PuzzleFormat::fmt_letters && c != '0') ?
+                    -1 : c - '0';
+            else if (c >= 'A' && c <= 'Z')
+                value = format == PuzzleFormat::fmt_hex ? c - 'A' + 11 :
+                    format == PuzzleFormat::fmt_letters ? c - 'A' + 1 :
+                    c - 'A' + 10;
+            else
+                value = -1;
+            if (value < 0 || value > (int)length)
+                return false;
+            digits.push_back((char)value);
+        }
+        return true;
+    }
+
+    static inline char lineSymbol(int digit, PuzzleFormat format)
+    {
+        switch (format)
+        {
+        case PuzzleFormat::fmt_hex:
+            return digit == 0 ? '.' : "0123456789ABCDEF"[digit - 1];
+        case PuzzleFormat::fmt_letters:
+            return digit == 0 ? '.' : (char)('A' + digit - 1);
+        default:
+            return digit <= 9 ? (char)('0' + digit) : (char)('A' + digit - 10);
+        }
+    }
+
+    bool PuzzleReader::next(std::vector<char>& digits, unsigned int& length,
+        PuzzleFormat& format)
+    {
+        if (!isOpen())
+            return false;
+        digits.clear();
+        csvRows = 0;
+        unsigned int rowLength = 0;
+        bool isBroken = false;
+        while (readLine())
+        {
+            if (isBlankLine())
+            {
+                /* end of a csv grid */
+                if (csvRows == 0)
+                    continue;
+                if (!isBroken && csvRows == rowLength &&
+                    isGridSize(digits.size(), length))
+                {
+                    format = PuzzleFormat::fmt_csv;
+                    return true;
+                }
+                std::fprintf(stderr, "batch: malformed grid before line %lu\r\n",
+                    lineNo);
+                skipped++;
+                digits.clear();
+                csvRows = 0;
+                isBroken = false;
+                continue;
+            }
+            if (csvRows == 0 && isLinePuzzle())
+            {
+                /* one puzzle per line */
+                if (parseLinePuzzle(line, lineLen, digits, length, format))
+                    return true;
+                std::fprintf(stderr, "batch: malformed puzzle in line %lu\r\n",
+                    lineNo);
+                skipped++;
+                digits.clear();
+                continue;
+            }
+            /* a row of a csv grid */
+            unsigned int count = parseCSVRow(digits);
+            if (csvRows == 0)
+                rowLength = count;
+            if (count == 0 || count != rowLength)
+                isBroken = true;
+            csvRows++;
+            /* a grid is complete once it is square */
+            if (!isBroken && csvRows == rowLength &&
+                isGridSize(digits.size(), length))
+            {
+                format = PuzzleFormat::fmt_csv;
+                return true;
+            }
+        }
+        /* the last csv grid may not be followed by a blank line */
+        if (csvRows != 0)
+        {
+            std::fprintf(stderr, "batch: malformed grid at the end of input\r\n");
+            skipped++;
+        }
+        return false;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,4 @@
+#ifndef PUZZLEREADER_H
+#define PUZZLEREADER_H
+#include "PuzzleReader.cxx"
+#endif
\ No newline at end of file
@@ -0,0 +1,232 @@
+/*******************************************
+ * @title   Thread pool
+ * @brief   work-stealing thread pool
+ * @author  Bin Qu
+ * @date    2026.10.17
+ * @copyright   You can edit and remodify
+ * this file.
+*******************************************/
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace sds
+{
+    /**
+     * Thread pool where every worker owns a deque of
+     * tasks. A worker takes its newest task first and,
+     * when its deque runs dry, steals the oldest task of
+     * another worker, so that a few slow tasks cannot
+     * leave the other cores idle.
+    */
+    class ThreadPool
+    {
+    public:
+        /**
+         * @brief task type, called with the index of the
+         * worker that runs it, so that tasks can use
+         * per-worker state.
+        */
+        typedef std::function<void(unsigned int)> Task;
+
+    private:
+        /**
+         * @brief task deque of a worker
+        */
+        struct TaskQueue
+        {
+            std::mutex lock;
+            std::deque<Task> tasks;
+        };
+        /**
+         * @brief one deque per worker
+        */
+        std::vector<TaskQueue> queues;
+        /**
+         * @brief worker threads
+        */
+        std::vector<std::thread> threads;
+        /**
+         * @brief protect sleeping and waking up
+        */
+        std::mutex idleLock;
+        /**
+         * @brief wake up idle workers
+        */
+        std::condition_variable idleCond;
+        /**
+         * @brief wake up wait()
+        */
+        std::condition_variable doneCond;
+        /**
+         * @brief the number of tasks submitted but
+         * not finished
+        */
+        std::atomic<unsigned long> pending;
+        /**
+         * @brief the number of tasks in deques
+        */
+        std::atomic<unsigned long> queued;
+        /**
+         * @brief next deque for tasks submitted from
+         * outside the pool
+        */
+        std::atomic<unsigned int> nextQueue;
+        /**
+         * @brief is the pool shutting down?
+        */
+        bool isStopping = false;
+
+        /**
+         * @brief the pool and worker index of
+         * the calling thread
+        */
+        static thread_local ThreadPool* currentPool;
+        static thread_local unsigned int currentWorker;
+
+        /**
+         * @brief take a task from own deque or steal one
+         * @param worker worker index
+         * @param task output task
+         * @return is a task taken?
+        */
+        bool popTask(unsigned int worker, Task& task);
+        /**
+         * @brief main loop of worker threads
+         * @param worker worker index
+        */
+        void workerLoop(unsigned int worker);
+
+    public:
+        /**
+         * @brief add a task. Tasks submitted by a worker go
+         * to its own deque, others are spread round robin.
+        */
+        void submit(Task task);
+        /**
+         * @brief block until every submitted task finishes.
+         * Do not call it from a task.
+        */
+        void wait();
+        /**
+         * @brief the number of workers
+        */
+        unsigned int Size() { return threads.size(); }
+        /**
+         * @brief constructor that starts workers
+         * @param threads the number of workers, 0 for one
+         * per hardware thread
+        */
+        ThreadPool(unsigned int threads);
+        /**
+         * @brief deconstructor that finishes remaining
+         * tasks and joins workers
+        */
+        ~ThreadPool();
+    };
+
+    thread_local ThreadPool* ThreadPool::currentPool = nullptr;
+    thread_local unsigned int ThreadPool::currentWorker = 0;
+
+    ThreadPool::ThreadPool(unsigned int threads)
+        : queues(threads == 0 ? (std::thread::hardware_concurrency() == 0 ?
+            1 : std::thread::hardware_concurrency()) : threads),
+        pending(0), queued(0), nextQueue(0)
+    {
+        for (unsigned int i = 0; i < queues.size(); i++)
+            this->threads.emplace_back(&ThreadPool::workerLoop, this, i);
+    }
+
+    ThreadPool::~ThreadPool()
+    {
+        {
+            std::lock_guard<std::mutex> guard(idleLock);
+            isStopping = true;
+        }
+        idleCond.notify_all();
+        for (unsigned int i = 0; i < threads.size(); i++)
+            threads[i].join();
+    }
+
+    void ThreadPool::submit(Task task)
+    {
+        unsigned int target = currentPool == this ? currentWorker :
+            nextQueue.fetch_add(1) % queues.size();
+        pending++;
+        {
+            /* pair with the predicate check of sleeping workers */
+            std::lock_guard<std::mutex> guard(idleLock);
+            queued++;
+        }
+        {
+            std::lock_guard<std::mutex> guard(queues[target].lock);
+            queues[target].tasks.push_back(std::move(task));
+        }
+        idleCond.notify_one();
+    }
+
+    void ThreadPool::wait()
+    {
+        std::unique_lock<std::mutex> guard(idleLock);
+        doneCond.wait(guard, [this] { return pending == 0; });
+    }
+
+    bool ThreadPool::popTask(unsigned int worker, Task& task)
+    {
+        /* own deque, newest first */
+        {
+            std::lock_guard<std::mutex> guard(queues[worker].lock);
+            if (!queues[worker].tasks.empty())
+            {
+                task = std::move(queues[worker].tasks.back());
+                queues[worker].tasks.pop_back();
+                queued--;
+                return true;
+            }
+        }
+        /* steal, oldest first */
+        for (unsigned int k = 1; k < queues.size(); k++)
+        {
+            TaskQueue& victim = queues[(worker + k) % queues.size()];
+            std::lock_guard<std::mutex> guard(victim.lock);
+            if (!victim.tasks.empty())
+            {
+                task = std::move(victim.tasks.front());
+                victim.tasks.pop_front();
+                queued--;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void ThreadPool::workerLoop(unsigned int worker)
+    {
+        currentPool = this;
+        currentWorker = worker;
+        Task task;
+        while (true)
+        {
+            if (popTask(worker, task))
+            {
+                task(worker);
+                task = nullptr;
+                if (pending.fetch_sub(1) == 1)
+                {
+                    std::lock_guard<std::mutex> guard(idleLock);
+                    doneCond.notify_all();
+                }
+                continue;
+            }
+            std::unique_lock<std::mutex> guard(idleLock);
+            idleCond.wait(guard, [this] { return isStopping || queued > 0; });
+            if (isStopping && queued == 0)
+                return;
+        }
+    }
+}
\ No newline at end of file
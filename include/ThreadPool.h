@@ -0,0 +1,4 @@
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+#include "ThreadPool.cxx"
+#endif
\ No newline at end of file
@@ -0,0 +1,520 @@
+/*******************************************
+ * @title   Batch
+ * @brief   solve many puzzles of one file
+ * back to back
+ * @author  Bin Qu
+ * @date    2026.10.17
+ * @copyright   You can edit and remodify
+ * this file.
+*******************************************/
+
+#include "canonical.h"
+#include "dlx.h"
+#include "element.h"
+#include "FixedGrid.h"
+#include "PuzzleReader.h"
+#include "rater.h"
+#include "solver.h"
+#include "stats.h"
+#include "store.h"
+#include "ThreadPool.h"
+#include "trace.h"
+#include "writer.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <condition_variable>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace sds
+{
+    /**
+     * A puzzle of a batch, solved in place
+    */
+    struct BatchJob
+    {
+        /* row-major digits, replaced by the solution once solved */
+        std::vector<char> digits;
+        unsigned int length;
+        PuzzleFormat format;
+        bool isSolved;
+        /* solutions found by countJob(), at most its limit */
+        unsigned long solutions;
+        /* set by rateJob() */
+        Rating rating;
+    };
+
+    /**
+     * Buffers a thread reuses for every puzzle it solves
+    */
+    struct SolveContext
+    {
+        Grid grid;
+        Searcher searcher;
+        DLXSolver dlx;
+        /* counters of this thread, attached only with --stats */
+        SolveStats stats;
+        /* solutions shared by every thread, nullptr for none */
+        SolutionCache* cache = nullptr;
+        Canonicalizer canonicalizer;
+        /* a solution in canonical layout */
+        std::string canonical;
+        /* solutions of earlier runs, nullptr for none */
+        SolutionStore* store = nullptr;
+        /* the clues of the puzzle being solved */
+        std::vector<char> puzzle;
+        SolveContext() : grid(9, 3) { grid.setVerbose(false); }
+    };
+
+    /**
+     * @brief append a puzzle to an output buffer
+     * @param digits row-major digits, 0 for empty
+     * @param length grid size length
+     * @param format layout of the puzzle
+     * @param out output buffer
+    */
+    static void formatPuzzle(const char* digits, unsigned int length,
+        PuzzleFormat format, std::string& out);
+
+    /**
+     * @brief solve a batch job, through the context's cache
+     * and store if it has them
+     * @param job job to solve
+     * @param context buffers of the calling thread
+     * @param isDLX use dancing links instead of the logic engine
+    */
+    static void solveJob(BatchJob& job, SolveContext& context, bool isDLX);
+
+    /**
+     * @brief count the solutions of a batch job, leaving
+     * its digits as they are
+     * @param job job to count
+     * @param context buffers of the calling thread
+     * @param isDLX use dancing links instead of the logic engine
+     * @param limit stop once this many are found
+    */
+    static void countJob(BatchJob& job, SolveContext& context, bool isDLX,
+        unsigned long limit);
+
+    /**
+     * @brief rate a batch job, leaving its digits as they are
+     * @param job job to rate
+     * @param context buffers of the calling thread
+    */
+    static void rateJob(BatchJob& job, SolveContext& context);
+
+    /**
+     * What a batch does with its puzzles, and with what help
+    */
+    struct BatchOptions
+    {
+        /* use dancing links instead of the logic engine */
+        bool isDLX = false;
+        /* solving threads, 0 for one per hardware thread */
+        unsigned int threads = 1;
+        /* if not nullptr, receives the work of every thread and
+        the read/solve/write phase durations */
+        SolveStats* stats = nullptr;
+        /* if not 0, count solutions up to limit instead, and
+        write one count per puzzle */
+        unsigned long limit = 0;
+        /* rate each puzzle instead, and write
+        "score,rule,max_ie,nodes" per puzzle */
+        bool isRating = false;
+        /* if not nullptr, solutions are looked up in and added
+        to them, the cache first */
+        SolutionCache* cache = nullptr;
+        SolutionStore* store = nullptr;
+        /* encoding of the solutions */
+        Encoding encoding = enc_input;
+        /* if not nullptr, solutions are written to it as
+        records at fixed offsets instead of to stdout */
+        RecordFile* output = nullptr;
+    };
+
+    /**
+     * Outcomes of the puzzles of a batch
+    */
+    struct BatchTally
+    {
+        unsigned long solved = 0;
+        unsigned long failed = 0;
+        /* puzzles without a solution, when counting */
+        unsigned long unsolvable = 0;
+        /* puzzles the rules alone solve, when rating */
+        unsigned long logical = 0;
+    };
+
+    /**
+     * @brief solve, count or rate a batch job as options say
+     * @param job job to run
+     * @param context buffers of the calling thread
+     * @param options what to do
+    */
+    static void runJob(BatchJob& job, SolveContext& context,
+        const BatchOptions& options);
+
+    /**
+     * @brief tally the outcome of a finished job. A solution
+     * that does not fit the records of options.output fails.
+     * @param job finished job
+     * @param options what was done
+     * @param tally receives the outcome
+    */
+    static void tallyJob(const BatchJob& job, const BatchOptions& options,
+        BatchTally& tally);
+
+    /**
+     * @brief append the output of a finished job: its count,
+     * its rating or its solution in options.encoding. A
+     * solution that does not fit the records of options.output
+     * leaves a record of zero bytes.
+     * @param job finished job
+     * @param options what was done
+     * @param out output buffer
+    */
+    static void appendJob(const BatchJob& job, const BatchOptions& options,
+        std::string& out);
+
+    /**
+     * @brief print the one-line summary of a batch to stderr
+     * @param skipped malformed puzzles the reader dropped
+     * @param seconds wall time
+     * @param workers the number of solving threads
+     * @return 0 if every puzzle is solved, or has exactly one
+     * solution when counting
+    */
+    static int printBatchSummary(const BatchOptions& options,
+        const BatchTally& tally, unsigned long skipped, double seconds,
+        unsigned int workers);
+
+    /**
+     * @brief solve every puzzle of a batch file and write
+     * one solution per puzzle to stdout, or to options.output,
+     * in input order. Unsolvable puzzles are written back
+     * unchanged.
+     * A window of puzzles rolls over the file: as the
+     * oldest is written the next one is read and handed to
+     * the pool.
+     * @param filename batch file path, "-" for stdin
+     * @param options what to do
+     * @return 0 if every puzzle is solved, or has exactly one
+     * solution when counting
+    */
+    static int runBatch(const std::string& filename,
+        const BatchOptions& options);
+
+    static void formatPuzzle(const char* digits, unsigned int length,
+        PuzzleFormat format, std::string& out)
+    {
+        const unsigned int sizegrid = length * length;
+        if (format != PuzzleFormat::fmt_csv)
+        {
+            for (unsigned int i = 0; i < sizegrid; i++)
+                out += lineSymbol(digits[i], format);
+            out += "\r\n";
+            return;
+        }
+        for (unsigned int i = 0; i < sizegrid; i++)
+        {
+            appendDecimal(digits[i], out);
+            out += (i % length == length - 1) ? "\r\n" : ",";
+        }
+        out += "\r\n";
+    }
+
+    static void solveJob(BatchJob& job, SolveContext& context, bool isDLX)
+    {
+        /* a symmetric copy of a solved puzzle maps its solution back */
+        const bool isCaching = context.cache != nullptr &&
+            context.canonicalizer.canonicalize(job.digits.data(), job.length);
+        if (isCaching && context.cache->find(context.canonicalizer,
+            context.canonical))
+        {
+            context.canonicalizer.fromCanonical(context.canonical.data(),
+                job.digits.data());
+            job.isSolved = true;
+            return;
+        }
+        /* a puzzle solved by an earlier run is read back from disk */
+        SolutionStore* store = context.store;
+        if (store != nullptr)
+            context.puzzle.assign(job.digits.begin(), job.digits.end());
+        if (store != nullptr && store->find(context.puzzle.data(), job.length,
+            job.digits.data()))
+            job.isSolved = true;
+        else
+        {
+            Grid& grid = context.grid;
+            grid.resize(job.length, (unsigned int)std::sqrt(job.length));
+            grid.load(job.digits.data());
+            job.isSolved = isDLX ? context.dlx.solve(grid) :
+                solveDispatch(grid, context.searcher);
+            if (isDLX && grid.Stats() != nullptr)
+                grid.Stats()->search_nodes += context.dlx.Nodes();
+            if (job.isSolved)
+                std::memcpy(job.digits.data(), grid.Lattices(), grid.Size());
+            if (job.isSolved && store != nullptr)
+                store->insert(context.puzzle.data(), job.digits.data(),
+                    job.length);
+        }
+        if (isCaching && job.isSolved)
+        {
+            context.canonical.resize(job.digits.size());
+            context.canonicalizer.toCanonical(job.digits.data(),
+                &context.canonical[0]);
+            context.cache->insert(context.canonicalizer, context.canonical);
+        }
+    }
+
+    static void countJob(BatchJob& job, SolveContext& context, bool isDLX,
+        unsigned long limit)
+    {
+        Grid& grid = context.grid;
+        grid.resize(job.length, (unsigned int)std::sqrt(job.length));
+        grid.load(job.digits.data());
+        job.solutions = isDLX ? context.dlx.count(grid, limit, nullptr) :
+            countDispatch(grid, context.searcher, limit, nullptr);
+        if (isDLX && grid.Stats() != nullptr)
+            grid.Stats()->search_nodes += context.dlx.Nodes();
+        job.isSolved = job.solutions == 1;
+    }
+
+    static void rateJob(BatchJob& job, SolveContext& context)
+    {
+        Grid& grid = context.grid;
+        grid.resize(job.length, (unsigned int)std::sqrt(job.length));
+        grid.load(job.digits.data());
+        rateDispatch(grid, context.searcher, job.rating);
+        job.isSolved = job.rating.rule != rule_unsolvable;
+    }
+
+    static void runJob(BatchJob& job, SolveContext& context,
+        const BatchOptions& options)
+    {
+        if (options.isRating)
+            rateJob(job, context);
+        else if (options.limit != 0)
+            countJob(job, context, options.isDLX, options.limit);
+        else
+            solveJob(job, context, options.isDLX);
+    }
+
+    static void tallyJob(const BatchJob& job, const BatchOptions& options,
+        BatchTally& tally)
+    {
+        const bool isFit = options.output == nullptr ||
+            job.length == options.output->Length();
+        if (job.isSolved && isFit)
+            tally.solved++;
+        else
+            tally.failed++;
+        if (options.isRating)
+            tally.logical += job.isSolved && job.rating.rule != rule_search;
+        else if (options.limit != 0)
+            tally.unsolvable += job.solutions == 0;
+    }
+
+    static void appendJob(const BatchJob& job, const BatchOptions& options,
+        std::string& out)
+    {
+        if (options.isRating)
+        {
+            const Rating& rating = job.rating;
+            char tmpStr[64];
+            std::snprintf(tmpStr, sizeof(tmpStr), "%lu,%s,%u,%lu\r\n",
+                rating.score, ruleName(rating.rule), rating.max_ie,
+                rating.nodes);
+            out += tmpStr;
+        }
+        else if (options.limit != 0)
+        {
+            appendDecimal(job.solutions, out);
+            out += "\r\n";
+        }
+        else if (options.encoding == enc_input)
+            formatPuzzle(job.digits.data(), job.length, job.format, out);
+        /* a record of another grid size would shift the rest */
+        else if (options.output != nullptr &&
+            job.length != options.output->Length())
+            out.append(options.output->RecordBytes(), '\0');
+        else
+            appendRecord(job.digits.data(), job.length, options.encoding,
+                out);
+    }
+
+    static int printBatchSummary(const BatchOptions& options,
+        const BatchTally& tally, unsigned long skipped, double seconds,
+        unsigned int workers)
+    {
+        const unsigned long total = tally.solved + tally.failed;
+        const double rate = seconds > 0 ? total / seconds : 0.0;
+        if (options.isRating)
+            std::fprintf(stderr,
+                "rate: %lu puzzles, %lu by rules alone, %lu need search, "
+                "%lu unsolvable, %lu skipped in %.3f s (%.1f puzzles/sec, "
+                "%u threads)\r\n",
+                total, tally.logical, tally.solved - tally.logical,
+                tally.failed, skipped, seconds, rate, workers);
+        /* a count stopped at 1 cannot tell unique puzzles */
+        else if (options.limit > 1)
+            std::fprintf(stderr,
+                "batch: %lu puzzles, %lu unique, %lu multiple, %lu unsolvable, "
+                "%lu skipped in %.3f s (%.1f puzzles/sec, %u threads)\r\n",
+                total, tally.solved, tally.failed - tally.unsolvable,
+                tally.unsolvable, skipped, seconds, rate, workers);
+        else
+            std::fprintf(stderr,
+                "batch: %lu puzzles, %lu solved, %lu failed, %lu skipped "
+                "in %.3f s (%.1f puzzles/sec, %u threads)\r\n",
+                total, tally.solved, tally.failed, skipped, seconds, rate,
+                workers);
+        return (tally.failed == 0 && skipped == 0) ? 0 : -1;
+    }
+
+    static int runBatch(const std::string& filename,
+        const BatchOptions& options)
+    {
+        PuzzleReader reader(filename);
+        if (!reader.isOpen())
+            return -1;
+
+        /* a single thread solves in place, no pool needed */
+        std::unique_ptr<ThreadPool> pool;
+        if (options.threads != 1)
+            pool.reset(new ThreadPool(options.threads));
+        const unsigned int workers = pool ? pool->Size() : 1;
+
+        /* buffers reused by every puzzle of the window */
+        SolveStats* stats = options.stats;
+        std::vector<SolveContext> contexts(workers);
+        for (SolveContext& context : contexts)
+        {
+            if (stats != nullptr)
+                context.grid.setStats(&context.stats);
+            context.cache = options.cache;
+            context.store = options.store;
+        }
+        /* puzzle k lives in jobs[k % jobs.size()] until written */
+        std::vector<BatchJob> jobs(1024 * workers);
+        /* set by the worker that solved a slot, under doneLock */
+        std::vector<char> isDone(jobs.size(), 0);
+        std::mutex doneLock;
+        std::condition_variable doneCond;
+        std::string out;
+        RecordFile* output = options.output;
+        /* records written to output so far */
+        unsigned long written = 0;
+        /* write out to output or stdout, and empty it */
+        auto flush = [&out, output, &written]()
+        {
+            if (out.empty())
+                return;
+            if (output != nullptr)
+            {
+                output->write(written, out.data(), out.size());
+                written += out.size() / output->RecordBytes();
+            }
+            else
+                std::fwrite(out.data(), 1, out.size(), stdout);
+            out.clear();
+        };
+
+        BatchTally tally;
+        auto startTime = std::chrono::steady_clock::now();
+        auto phaseTime = startTime;
+        /* add the time since the last phase ended to a phase */
+        auto endPhase = [&phaseTime, stats](double& phase_ms)
+        {
+            if (stats == nullptr)
+                return;
+            auto now = std::chrono::steady_clock::now();
+            phase_ms += std::chrono::duration<double, std::milli>(
+                now - phaseTime).count();
+            phaseTime = now;
+        };
+        /* puzzles read, and puzzles written */
+        unsigned long read = 0;
+        unsigned long next = 0;
+        bool isReadDone = false;
+        while (true)
+        {
+            /* fill the free slots, one task per puzzle so idle
+            workers can steal */
+            while (!isReadDone && read - next < jobs.size())
+            {
+                const unsigned int slot = read % jobs.size();
+                BatchJob& job = jobs[slot];
+                if (!reader.next(job.digits, job.length, job.format))
+                {
+                    isReadDone = true;
+                    break;
+                }
+                /* the first puzzle sets the size of every record */
+                if (output != nullptr && output->Length() == 0)
+                    output->setLength(job.length);
+                read++;
+                if (!pool)
+                    continue;
+                isDone[slot] = 0;
+                pool->submit([&jobs, &contexts, &options, &isDone, &doneLock,
+                    &doneCond, slot](unsigned int worker)
+                {
+                    runJob(jobs[slot], contexts[worker], options);
+                    /* notify under the lock, so the waiter cannot
+                    return and free doneCond before it is done */
+                    std::lock_guard<std::mutex> guard(doneLock);
+                    isDone[slot] = 1;
+                    doneCond.notify_one();
+                });
+            }
+            if (stats != nullptr)
+                endPhase(stats->initialize_ms);
+            if (next == read)
+                break;
+
+            /* wait for the oldest puzzle, or solve it in place */
+            const unsigned int slot = next % jobs.size();
+            if (pool)
+            {
+                std::unique_lock<std::mutex> guard(doneLock);
+                doneCond.wait(guard, [&isDone, slot]()
+                    { return isDone[slot] != 0; });
+            }
+            else
+                runJob(jobs[slot], contexts[0], options);
+            if (stats != nullptr)
+                endPhase(stats->solve_ms);
+
+            /* write in input order, in big chunks */
+            tallyJob(jobs[slot], options, tally);
+            appendJob(jobs[slot], options, out);
+            if (out.size() >= (1 << 16))
+                flush();
+            next++;
+            if (next % jobs.size() == 0)
+                traceFlush();
+            if (stats != nullptr)
+                endPhase(stats->output_ms);
+        }
+        flush();
+        traceFlush();
+        std::fflush(stdout);
+        if (stats != nullptr)
+        {
+            endPhase(stats->output_ms);
+            for (SolveContext& context : contexts)
+                stats->merge(context.stats);
+        }
+
+        double seconds = std::chrono::duration<double>(
+            std::chrono::steady_clock::now() - startTime).count();
+        return printBatchSummary(options, tally, reader.skipped, seconds,
+            workers);
+    }
+}
\ No newline at end of file
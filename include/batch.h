@@ -0,0 +1,4 @@
+#ifndef BATCH_H
+#define BATCH_H
+#include "batch.cxx"
+#endif
\ No newline at end of file
@@ -0,0 +1,199 @@
+/*******************************************
+ * @title   Benchmark
+ * @brief   time the engines over puzzle
+ * corpora and report throughput and latency
+ * @author  Bin Qu
+ * @date    2026.10.17
+ * @copyright   You can edit and remodify
+ * this file.
+*******************************************/
+
+#include "batch.h"
+#include "PuzzleReader.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace sds
+{
+    /**
+     * Timings of one engine over one corpus
+    */
+    struct BenchResult
+    {
+        /* corpus name, the file name without directory and extension */
+        std::string corpus;
+        const char* engine;
+        /* puzzles per pass, and passes timed */
+        unsigned long puzzles;
+        unsigned int passes;
+        /* solutions that are complete, valid and keep every clue */
+        unsigned long solved;
+        unsigned long skipped;
+        /* wall time of all passes */
+        double seconds;
+        /* latency of a single solve, in microseconds */
+        double mean_us;
+        double p50_us;
+        double p99_us;
+    };
+
+    /**
+     * @brief check a solution against its puzzle
+     * @param clues row-major puzzle, 0 for empty
+     * @param solution row-major solution
+     * @param length grid size length
+     * @return true if every row, column and block holds each
+     * digit once and every clue is kept
+    */
+    static bool isValidSolution(const char* clues, const char* solution,
+        unsigned int length);
+
+    /**
+     * @brief solve every puzzle of a corpus passes times on
+     * one thread, timing each solve
+     * @param filename corpus in any format PuzzleReader accepts
+     * @param isDLX use dancing links instead of the logic engine
+     * @param passes how many times the corpus is solved, after
+     * one untimed warm-up pass
+     * @param result filled with the timings
+     * @return false if the corpus cannot be read or is empty
+    */
+    static bool runBenchmark(const std::string& filename, bool isDLX,
+        unsigned int passes, BenchResult& result);
+
+    /**
+     * @brief print a result as one JSON object per line,
+     * or as a CSV row
+     * @param isCSV print CSV instead of JSON
+     * @param isHeader print the CSV header first
+    */
+    static void printBenchResult(const BenchResult& result, bool isCSV,
+        bool isHeader);
+
+    static bool isValidSolution(const char* clues, const char* solution,
+        unsigned int length)
+    {
+        const unsigned int blocklength = (unsigned int)std::sqrt(length);
+        std::vector<unsigned char> seen(3 * length * length, 0);
+        for (unsigned int i = 0; i < length * length; i++)
+        {
+            const int digit = solution[i];
+            if (digit < 1 || digit > (int)length)
+                return false;
+            if (clues[i] != 0 && clues[i] != digit)
+                return false;
+            const unsigned int row = i / length;
+            const unsigned int col = i % length;
+            const unsigned int block = row / blocklength * blocklength +
+                col / blocklength;
+            unsigned char& inRow = seen[row * length + digit - 1];
+            unsigned char& inCol = seen[(length + col) * length + digit - 1];
+            unsigned char& inBlock =
+                seen[(2 * length + block) * length + digit - 1];
+            if (inRow || inCol || inBlock)
+                return false;
+            inRow = inCol = inBlock = 1;
+        }
+        return true;
+    }
+
+    static bool runBenchmark(const std::string& filename, bool isDLX,
+        unsigned int passes, BenchResult& result)
+    {
+        PuzzleReader reader(filename);
+        if (!reader.isOpen())
+            return false;
+
+        /* load the whole corpus so only solving is timed */
+        std::vector<BatchJob> puzzles;
+        BatchJob job;
+        while (reader.next(job.digits, job.length, job.format))
+            puzzles.push_back(job);
+        if (puzzles.empty())
+            return false;
+
+        std::string::size_type slash = filename.find_last_of("/\\");
+        result.corpus = filename.substr(slash == std::string::npos ? 0 :
+            slash + 1);
+        result.corpus = result.corpus.substr(0, result.corpus.rfind('.'));
+        result.engine = isDLX ? "dlx" : "logic";
+        result.puzzles = puzzles.size();
+        result.passes = passes;
+        result.skipped = reader.skipped;
+        result.solved = 0;
+
+        SolveContext context;
+        std::vector<double> latencies;
+        latencies.reserve(puzzles.size() * passes);
+        auto startTime = std::chrono::steady_clock::now();
+        for (unsigned int pass = 0; pass <= passes; pass++)
+        {
+            /* pass 0 warms up buffers and caches */
+            if (pass == 1)
+                startTime = std::chrono::steady_clock::now();
+            for (const BatchJob& puzzle : puzzles)
+            {
+                job = puzzle;
+                auto solveTime = std::chrono::steady_clock::now();
+                solveJob(job, context, isDLX);
+                auto endTime = std::chrono::steady_clock::now();
+                if (pass == 0)
+                    continue;
+                latencies.push_back(std::chrono::duration<double,
+                    std::micro>(endTime - solveTime).count());
+                if (job.isSolved && isValidSolution(puzzle.digits.data(),
+                    job.digits.data(), job.length))
+                    result.solved++;
+            }
+        }
+        result.seconds = std::chrono::duration<double>(
+            std::chrono::steady_clock::now() - startTime).count();
+        /* count solved puzzles once, not once per pass */
+        result.solved /= passes;
+
+        double total = 0;
+        for (double latency : latencies)
+            total += latency;
+        std::sort(latencies.begin(), latencies.end());
+        const unsigned long n = latencies.size();
+        result.mean_us = total / n;
+        result.p50_us = latencies[(n - 1) / 2];
+        result.p99_us = latencies[(unsigned long)std::ceil(0.99 * n) - 1];
+        return true;
+    }
+
+    static void printBenchResult(const BenchResult& result, bool isCSV,
+        bool isHeader)
+    {
+        const double rate = result.seconds > 0 ?
+            result.puzzles * result.passes / result.seconds : 0.0;
+        const double fraction = (double)result.solved / result.puzzles;
+        if (isCSV)
+        {
+            if (isHeader)
+                std::printf("corpus,engine,puzzles,passes,solved,"
+                    "solved_fraction,skipped,seconds,puzzles_per_sec,"
+                    "mean_us,p50_us,p99_us\r\n");
+            std::printf("%s,%s,%lu,%u,%lu,%.4f,%lu,%.6f,%.1f,%.2f,%.2f,"
+                "%.2f\r\n", result.corpus.c_str(), result.engine,
+                result.puzzles, result.passes, result.solved, fraction,
+                result.skipped, result.seconds, rate, result.mean_us,
+                result.p50_us, result.p99_us);
+            return;
+        }
+        std::printf("{\"corpus\": \"%s\", \"engine\": \"%s\", "
+            "\"puzzles\": %lu, \"passes\": %u, \"solved\": %lu, "
+            "\"solved_fraction\": %.4f, \"skipped\": %lu, "
+            "\"seconds\": %.6f, \"puzzles_per_sec\": %.1f, "
+            "\"mean_us\": %.2f, \"p50_us\": %.2f, \"p99_us\": %.2f}\r\n",
+            result.corpus.c_str(), result.engine, result.puzzles,
+            result.passes, result.solved, fraction, result.skipped,
+            result.seconds, rate, result.mean_us, result.p50_us,
+            result.p99_us);
+    }
+}
\ No newline at end of file
@@ -0,0 +1,4 @@
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+#include "benchmark.cxx"
+#endif
\ No newline at end of file
@@ -0,0 +1,66 @@
+/*******************************************
+ * @title   Bits
+ * @brief   bit tricks on candidate words
+ * @author  Bin Qu
+ * @date    2026.10.17
+ * @copyright   You can edit and remodify
+ * this file.
+*******************************************/
+
+#include <cstdint>
+
+namespace sds
+{
+    /**
+     * @brief count set bits
+    */
+    static inline unsigned int bitCount(std::uint64_t w);
+    /**
+     * @brief index of the lowest set bit, w must not be 0
+    */
+    static inline unsigned int lowBit(std::uint64_t w);
+
+#if defined(__GNUC__) || defined(__clang__)
+    static inline unsigned int bitCount(std::uint64_t w)
+    { return __builtin_popcountll(w); }
+
+    static inline unsigned int lowBit(std::uint64_t w)
+    { return __builtin_ctzll(w); }
+#else
+    static inline unsigned int bitCount(std::uint64_t w)
+    {
+        unsigned int count = 0;
+        for (; w != 0; w &= w - 1)
+            count++;
+        return count;
+    }
+
+    static inline unsigned int lowBit(std::uint64_t w)
+    {
+        unsigned int idx = 0;
+        for (; (w & 1) == 0; w >>= 1)
+            idx++;
+        return idx;
+    }
+#endif
+
+    static inline unsigned int bitCount(std::uint32_t w)
+    { return bitCount((std::uint64_t)w); }
+    static inline unsigned int bitCount(std::uint16_t w)
+    { return bitCount((std::uint64_t)w); }
+    static inline unsigned int lowBit(std::uint32_t w)
+    { return lowBit((std::uint64_t)w); }
+    static inline unsigned int lowBit(std::uint16_t w)
+    { return lowBit((std::uint64_t)w); }
+
+#ifdef __SIZEOF_INT128__
+    static inline unsigned int bitCount(unsigned __int128 w)
+    { return bitCount((std::uint64_t)w) + bitCount((std::uint64_t)(w >> 64)); }
+
+    static inline unsigned int lowBit(unsigned __int128 w)
+    {
+        return (std::uint64_t)w != 0 ? lowBit((std::uint64_t)w) :
+            64 + lowBit((std::uint64_t)(w >> 64));
+    }
+#endif
+}
\ No newline at end of file
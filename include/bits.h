@@ -0,0 +1,4 @@
+#ifndef BITS_H
+#define BITS_H
+#include "bits.cxx"
+#endif
\ No newline at end of file
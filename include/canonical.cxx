@@ -0,0 +1,495 @@
+/*******************************************
+ * @title   Canonical
+ * @brief   map puzzles to a canonical form under
+ * the sudoku symmetries and cache their solutions
+ * @author  Bin Qu
+ * @date    2026.10.17
+ * @copyright   You can edit and remodify
+ * this file.
+*******************************************/
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace sds
+{
+    /**
+     * Maps a puzzle to one representative of its class under
+     * the sudoku symmetries: transposition, band and stack
+     * permutations, row and column permutations inside them,
+     * and digit relabeling. Rows and columns are first sorted
+     * by clue counts, which the symmetries keep, so only the
+     * orders between units that tie are tried; the smallest
+     * relabeled grid among them is the form. Puzzles with the
+     * same form are related by a symmetry, so a solution of one
+     * maps to a solution of the other.
+    */
+    class Canonicalizer
+    {
+    public:
+        /**
+         * @brief give up on puzzles whose ties leave more
+         * orders than this to try
+        */
+        static constexpr unsigned long MAX_CANDIDATES = 1 << 12;
+
+    private:
+        /**
+         * @brief equal keys that may be ordered either way
+        */
+        struct TieGroup
+        {
+            unsigned int* begin;
+            unsigned int* end;
+        };
+
+        unsigned int length = 0;
+        unsigned int block = 0;
+        /**
+         * @brief the puzzle, transposed or not
+        */
+        std::vector<char> view;
+        /**
+         * @brief band order then the row order inside each
+         * source band, and the same for stacks and columns
+        */
+        std::vector<unsigned int> rowPerm;
+        std::vector<unsigned int> colPerm;
+        /**
+         * @brief keys of the units of view
+        */
+        std::vector<std::uint64_t> rowKeys;
+        std::vector<std::uint64_t> colKeys;
+        std::vector<TieGroup> groups;
+        /**
+         * @brief rows and columns of view in output order
+        */
+        std::vector<unsigned int> rowsMap;
+        std::vector<unsigned int> colsMap;
+        /**
+         * @brief the candidate being built, and the form
+        */
+        std::string candidate;
+        std::string form;
+        /**
+         * @brief source digit to form digit and back, of the
+         * form's transform
+        */
+        std::vector<char> label;
+        std::vector<char> inverse;
+        /**
+         * @brief source address of each form lattice
+        */
+        std::vector<unsigned int> source;
+        std::uint64_t hash = 0;
+
+        /**
+         * @brief key of every row of view: its clue count, then
+         * the sorted clue counts of its stacks, in base block + 1
+        */
+        void computeKeys(std::vector<std::uint64_t>& keys, bool isColumn);
+        /**
+         * @brief sort bands by their sorted row keys and rows by
+         * key inside bands, and record the ties
+         * @param perm receives the orders
+         * @param keys row keys
+         * @return the number of orders the ties allow, at most
+         * MAX_CANDIDATES + 1
+        */
+        unsigned long orderUnits(std::vector<unsigned int>& perm,
+            const std::vector<std::uint64_t>& keys);
+        /**
+         * @brief output order of rows from perm
+        */
+        void expand(const std::vector<unsigned int>& perm,
+            std::vector<unsigned int>& map);
+        /**
+         * @brief relabel view under rowsMap and colsMap into
+         * candidate and keep it if it beats form
+        */
+        void tryCandidate(bool isFirst, bool isTransposed);
+
+    public:
+        /**
+         * @brief compute the canonical form of a puzzle
+         * @param digits row-major digits, 0 for empty
+         * @param length grid size length
+         * @return false if the size is not a square or the
+         * puzzle is too symmetric to canonicalize cheaply
+        */
+        bool canonicalize(const char* digits, unsigned int length);
+        /**
+         * @brief the canonical digits of the last puzzle
+        */
+        const std::string& Form() const { return form; }
+        /**
+         * @brief 64-bit FNV-1a hash of Form()
+        */
+        std::uint64_t Hash() const { return hash; }
+        /**
+         * @brief map a grid of the last puzzle's layout, e.g.
+         * its solution, into the canonical layout
+        */
+        void toCanonical(const char* grid, char* out) const;
+        /**
+         * @brief map a grid of the canonical layout back to
+         * the last puzzle's layout
+        */
+        void fromCanonical(const char* grid, char* out) const;
+    };
+
+    /**
+     * Bounded least recently used map from canonical forms to
+     * canonical solutions, shared by threads. It is split into
+     * shards by hash, each with its own lock, and evicted nodes
+     * are reused, so a full cache stops allocating.
+    */
+    class SolutionCache
+    {
+    private:
+        static constexpr unsigned int SHARDS = 16;
+        struct Entry
+        {
+            std::uint64_t hash;
+            std::string form;
+            std::string solution;
+        };
+        struct Shard
+        {
+            std::mutex lock;
+            /* most recently used first */
+            std::list<Entry> entries;
+            std::unordered_map<std::uint64_t,
+                std::list<Entry>::iterator> index;
+        };
+        Shard shards[SHARDS];
+        unsigned long capacity;
+        std::atomic<unsigned long> hits;
+        std::atomic<unsigned long> misses;
+
+    public:
+        /**
+         * @brief look up the last puzzle of a canonicalizer
+         * @param solution receives the canonical solution
+         * @return is it cached?
+        */
+        bool find(const Canonicalizer& canonical, std::string& solution);
+        /**
+         * @brief cache the canonical solution of the last
+         * puzzle of a canonicalizer, evicting the least
+         * recently used entry of its shard when full
+        */
+        void insert(const Canonicalizer& canonical,
+            const std::string& solution);
+        unsigned long Hits() const { return hits.load(); }
+        unsigned long Misses() const { return misses.load(); }
+        /**
+         * @brief constructor
+         * @param capacity the number of entries kept
+        */
+        SolutionCache(unsigned long capacity);
+    };
+
+    void Canonicalizer::computeKeys(std::vector<std::uint64_t>& keys,
+        bool isColumn)
+    {
+        unsigned int stacks[16];
+        for (unsigned int r = 0; r < length; r++)
+        {
+            unsigned int total = 0;
+            for (unsigned int s = 0; s < block; s++)
+            {
+                stacks[s] = 0;
+                for (unsigned int k = 0; k < block; k++)
+                {
+                    const unsigned int c = s * block + k;
+                    stacks[s] += (isColumn ? view[c * length + r] :
+                        view[r * length + c]) != 0;
+                }
+                total += stacks[s];
+            }
+            std::sort(stacks, stacks + block);
+            std::uint64_t key = total;
+            for (unsigned int s = 0; s < block; s++)
+                key = key * (block + 1) + stacks[s];
+            keys[r] = key;
+        }
+    }
+
+    unsigned long Canonicalizer::orderUnits(std::vector<unsigned int>& perm,
+        const std::vector<std::uint64_t>& keys)
+    {
+        unsigned long count = 1;
+        /* multiply count by n!, saturating */
+        auto tie = [&count](unsigned int n)
+        {
+            for (unsigned int k = 2; k <= n && count <= MAX_CANDIDATES; k++)
+                count *= k;
+        };
+        unsigned int* bands = perm.data();
+        unsigned int* rows = perm.data() + block;
+        for (unsigned int b = 0; b < block; b++)
+        {
+            bands[b] = b;
+            unsigned int* inside = rows + b * block;
+            for (unsigned int k = 0; k < block; k++)
+                inside[k] = k;
+            std::sort(inside, inside + block, [&](unsigned int x, unsigned int y)
+                { return keys[b * block + x] < keys[b * block + y] ||
+                    (keys[b * block + x] == keys[b * block + y] && x < y); });
+            for (unsigned int k = 0, first = 0; k <= block; k++)
+                if (k == block || keys[b * block + inside[k]] !=
+                    keys[b * block + inside[first]])
+                {
+                    if (k - first > 1)
+                        groups.push_back({inside + first, inside + k});
+                    tie(k - first);
+                    first = k;
+                }
+        }
+        /* a band is keyed by its sorted row keys */
+        auto bandLess = [&](unsigned int x, unsigned int y) -> int
+        {
+            for (unsigned int k = 0; k < block; k++)
+            {
+                const std::uint64_t a = keys[x * block + rows[x * block + k]];
+                const std::uint64_t b = keys[y * block + rows[y * block + k]];
+                if (a != b)
+                    return a < b ? -1 : 1;
+            }
+            return 0;
+        };
+        std::sort(bands, bands + block, [&](unsigned int x, unsigned int y)
+            { const int c = bandLess(x, y); return c < 0 || (c == 0 && x < y); });
+        for (unsigned int k = 0, first = 0; k <= block; k++)
+            if (k == block || bandLess(bands[k], bands[first]) != 0)
+            {
+                if (k - first > 1)
+                    groups.push_back({bands + first, bands + k});
+                tie(k - first);
+                first = k;
+            }
+        return count;
+    }
+
+    void Canonicalizer::expand(const std::vector<unsigned int>& perm,
+        std::vector<unsigned int>& map)
+    {
+        for (unsigned int i = 0; i < length; i++)
+        {
+            const unsigned int band = perm[i / block];
+            map[i] = band * block + perm[block + band * block + i % block];
+        }
+    }
+
+    void Canonicalizer::tryCandidate(bool isFirst, bool isTransposed)
+    {
+        char labels[128] = {0};
+        char next = 1;
+        /* -1 while equal to form so far, 1 once smaller */
+        int state = isFirst ? 1 : -1;
+        for (unsigned int i = 0; i < length; i++)
+        {
+            const char* row = view.data() + rowsMap[i] * length;
+            char* out = &candidate[i * length];
+            for (unsigned int j = 0; j < length; j++)
+            {
+                char v = row[colsMap[j]];
+                if (v != 0)
+                {
+                    if (labels[(int)v] == 0)
+                        labels[(int)v] = next++;
+                    v = labels[(int)v];
+                }
+                if (state < 0)
+                {
+                    const char f = form[i * length + j];
+                    if (v > f)
+                        return;
+                    if (v < f)
+                        state = 1;
+                }
+                out[j] = v;
+            }
+        }
+        if (state < 0)
+            return;
+        form.swap(candidate);
+        /* digits without a clue take the labels left, in order */
+        for (unsigned int v = 1; v <= length; v++)
+            if (labels[v] == 0)
+                labels[v] = next++;
+        for (unsigned int v = 1; v <= length; v++)
+        {
+            label[v] = labels[v];
+            inverse[(int)labels[v]] = v;
+        }
+        for (unsigned int i = 0; i < length; i++)
+            for (unsigned int j = 0; j < length; j++)
+                source[i * length + j] = isTransposed ?
+                    colsMap[j] * length + rowsMap[i] :
+                    rowsMap[i] * length + colsMap[j];
+    }
+
+    bool Canonicalizer::canonicalize(const char* digits, unsigned int length)
+    {
+        const unsigned int block = (unsigned int)std::sqrt(length);
+        if (block * block != length || block > 16 || length > 127)
+            return false;
+        const unsigned int size = length * length;
+        if (this->length != length)
+        {
+            this->length = length;
+            this->block = block;
+            view.resize(size);
+            rowPerm.resize(block + length);
+            colPerm.resize(block + length);
+            rowKeys.resize(length);
+            colKeys.resize(length);
+            rowsMap.resize(length);
+            colsMap.resize(length);
+            candidate.resize(size);
+            form.resize(size);
+            label.resize(length + 1);
+            inverse.resize(length + 1);
+            source.resize(size);
+        }
+
+        /* the orientation whose sorted row keys are smaller, or
+        both when they tie */
+        view.assign(digits, digits + size);
+        computeKeys(rowKeys, false);
+        computeKeys(colKeys, true);
+        std::uint64_t rowSorted[128];
+        std::uint64_t colSorted[128];
+        std::copy(rowKeys.begin(), rowKeys.end(), rowSorted);
+        std::copy(colKeys.begin(), colKeys.end(), colSorted);
+        std::sort(rowSorted, rowSorted + length);
+        std::sort(colSorted, colSorted + length);
+        const unsigned int side = std::lexicographical_compare(rowSorted,
+            rowSorted + length, colSorted, colSorted + length) ? 0 :
+            std::lexicographical_compare(colSorted, colSorted + length,
+            rowSorted, rowSorted + length) ? 1 : 2;
+
+        bool isFirst = true;
+        unsigned long tried = 0;
+        for (unsigned int t = 0; t < 2; t++)
+        {
+            if (side != 2 && side != t)
+                continue;
+            if (t == 1)
+            {
+                for (unsigned int r = 0; r < length; r++)
+                    for (unsigned int c = 0; c < length; c++)
+                        view[r * length + c] = digits[c * length + r];
+                computeKeys(rowKeys, false);
+                computeKeys(colKeys, true);
+            }
+            groups.clear();
+            unsigned long count = orderUnits(rowPerm, rowKeys);
+            count *= orderUnits(colPerm, colKeys);
+            tried += count;
+            if (tried > MAX_CANDIDATES)
+                return false;
+
+            /* every order of every tie group, like an odometer */
+            unsigned int g;
+            do
+            {
+                expand(rowPerm, rowsMap);
+                expand(colPerm, colsMap);
+                tryCandidate(isFirst, t == 1);
+                isFirst = false;
+                for (g = 0; g < groups.size(); g++)
+                    if (std::next_permutation(groups[g].begin, groups[g].end))
+                        break;
+            } while (g < groups.size());
+        }
+
+        hash = 14695981039346656037ULL;
+        for (unsigned int i = 0; i < size; i++)
+        {
+            hash ^= (unsigned char)form[i];
+            hash *= 1099511628211ULL;
+        }
+        return true;
+    }
+
+    void Canonicalizer::toCanonical(const char* grid, char* out) const
+    {
+        const unsigned int size = length * length;
+        for (unsigned int i = 0; i < size; i++)
+        {
+            const char v = grid[source[i]];
+            out[i] = v == 0 ? 0 : label[(int)v];
+        }
+    }
+
+    void Canonicalizer::fromCanonical(const char* grid, char* out) const
+    {
+        const unsigned int size = length * length;
+        for (unsigned int i = 0; i < size; i++)
+        {
+            const char v = grid[i];
+            out[source[i]] = v == 0 ? 0 : inverse[(int)v];
+        }
+    }
+
+    SolutionCache::SolutionCache(unsigned long capacity)
+        : capacity((capacity + SHARDS - 1) / SHARDS), hits(0), misses(0)
+    { }
+
+    bool SolutionCache::find(const Canonicalizer& canonical,
+        std::string& solution)
+    {
+        Shard& shard = shards[canonical.Hash() % SHARDS];
+        std::lock_guard<std::mutex> guard(shard.lock);
+        auto it = shard.index.find(canonical.Hash());
+        if (it == shard.index.end() || it->second->form != canonical.Form())
+        {
+            misses.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        shard.entries.splice(shard.entries.begin(), shard.entries, it->second);
+        solution = it->second->solution;
+        hits.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    void SolutionCache::insert(const Canonicalizer& canonical,
+        const std::string& solution)
+    {
+        Shard& shard = shards[canonical.Hash() % SHARDS];
+        std::lock_guard<std::mutex> guard(shard.lock);
+        auto it = shard.index.find(canonical.Hash());
+        if (it == shard.index.end())
+        {
+            if (shard.entries.size() < capacity)
+                shard.entries.emplace_front();
+            else
+            {
+                /* reuse the least recently used node */
+                shard.index.erase(shard.entries.back().hash);
+                shard.entries.splice(shard.entries.begin(), shard.entries,
+                    std::prev(shard.entries.end()));
+            }
+            it = shard.index.emplace(canonical.Hash(),
+                shard.entries.begin()).first;
+        }
+        else
+            shard.entries.splice(shard.entries.begin(), shard.entries,
+                it->second);
+        Entry& entry = *it->second;
+        entry.hash = canonical.Hash();
+        entry.form = canonical.Form();
+        entry.solution = solution;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,4 @@
+#ifndef CANONICAL_H
+#define CANONICAL_H
+#include "canonical.cxx"
+#endif
\ No newline at end of file
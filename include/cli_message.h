@@ -7,6 +7,55 @@ Options:\r\n\
   --help(-h)              Display this information.\r\n\
   --version(-v)           Display the version.\r\n\
   --file(-f) <file>       Process a sudoku game file.\r\n\
+  --engine(-e) <name>     Solve with \"logic\" (default) or \"dlx\".\r\n\
+  --batch(-b) <file>      Solve every puzzle of a file (\"-\" for stdin).\r\n\
+                          Puzzles are csv grids separated by blank\r\n\
+                          lines, or one line per puzzle (81 chars for\r\n\
+                          9x9, letters for 16x16 and 25x25).\r\n\
+  --threads(-t) <n>       Solve on n threads (0: all cores). A batch is\r\n\
+                          spread by puzzle, a single file by subtree.\r\n\
+  --stats(-s)             Print what the rules did and how long each\r\n\
+                          phase took, as JSON on stderr.\r\n\
+  --quiet(-q)             Trace nothing, same as --trace=off.\r\n\
+  --trace(-T) <level>     Trace \"off\", \"error\", \"info\" (default) or\r\n\
+                          \"debug\" (every filling) events on stderr.\r\n\
+  --count-solutions(-c)[=<n>]\r\n\
+                          Count solutions instead of solving, stopping\r\n\
+                          at n (default 2, 0 for no limit). A batch\r\n\
+                          writes one count per puzzle.\r\n\
+  --all-solutions(-a)     Print every solution of the file while\r\n\
+                          counting, as csv grids.\r\n\
+  --generate(-g) <n>      Generate n puzzles with a unique solution and\r\n\
+                          write them as csv grids, on --threads.\r\n\
+  --size(-n) <length>     Size of generated puzzles: 4, 9 (default), 16\r\n\
+                          or 25.\r\n\
+  --clues(-k) <n>         Stop removing clues at n (default: as few as\r\n\
+                          possible).\r\n\
+  --difficulty(-d) <name> \"any\" (default), \"easy\" (singles), \"medium\"\r\n\
+                          (subsets) or \"hard\" (needs a guess).\r\n\
+  --seed(-S) <n>          Seed of the generator (default: the clock).\r\n\
+  --rate(-r)              Rate every puzzle of a batch by the hardest\r\n\
+                          rule it takes, one \"score,rule,max_ie,nodes\"\r\n\
+                          line per puzzle.\r\n\
+  --serve(-l)[=<socket>]  Answer one-line puzzles, one per line, on a\r\n\
+                          Unix domain socket or on stdin/stdout, with\r\n\
+                          warm solvers. Big pipelined batches are\r\n\
+                          spread over --threads.\r\n\
+  --cache(-C)[=<n>]       Keep the solutions of the last n puzzles\r\n\
+                          (default 65536) by canonical form, so a\r\n\
+                          relabeled, transposed or permuted copy is\r\n\
+                          not solved again. For --batch and --serve.\r\n\
+  --store(-o) <file>      Look solutions up in a persistent store file\r\n\
+                          before solving, and add new ones to it.\r\n\
+                          Created on first use; shared by processes.\r\n\
+  --pipeline(-p)          Read, solve and write a batch at once: a\r\n\
+                          reader and a writer thread around --threads\r\n\
+                          workers, with flat memory on any input.\r\n\
+  --encoding(-E) <name>   Write batch solutions in the layout of each\r\n\
+                          puzzle (\"input\", default), or as fixed-size\r\n\
+                          \"csv\", \"line\" or \"binary\" records.\r\n\
+  --output(-w) <file>     Write batch solutions to a file instead, as\r\n\
+                          records at fixed offsets (\"line\" by default).\r\n\
 For more information, please see:\r\n\
 <https://github.com/BenQuickDeNN/SudokuSolver>.\r\n\
 "
@@ -7,5 +7,25 @@ static struct option long_options[] =
     {"help",    no_argument,        0,  'h'},
     {"version", no_argument,        0,  'v'},
     {"file",    required_argument,  0,  'f'},
+    {"engine",  required_argument,  0,  'e'},
+    {"batch",   required_argument,  0,  'b'},
+    {"threads", required_argument,  0,  't'},
+    {"stats",   no_argument,        0,  's'},
+    {"quiet",   no_argument,        0,  'q'},
+    {"trace",   required_argument,  0,  'T'},
+    {"count-solutions", optional_argument,  0,  'c'},
+    {"all-solutions",   no_argument,        0,  'a'},
+    {"generate",    required_argument,  0,  'g'},
+    {"size",        required_argument,  0,  'n'},
+    {"clues",       required_argument,  0,  'k'},
+    {"difficulty",  required_argument,  0,  'd'},
+    {"seed",        required_argument,  0,  'S'},
+    {"rate",        no_argument,        0,  'r'},
+    {"serve",       optional_argument,  0,  'l'},
+    {"cache",       optional_argument,  0,  'C'},
+    {"store",       required_argument,  0,  'o'},
+    {"pipeline",    no_argument,        0,  'p'},
+    {"encoding",    required_argument,  0,  'E'},
+    {"output",      required_argument,  0,  'w'},
     {0,         0,                  0,   0}
 };
\ No newline at end of file
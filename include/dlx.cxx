@@ -0,0 +1,362 @@
+/*******************************************
+ * @title   Dancing Links
+ * @brief   exact cover solver (Algorithm X)
+ * for sudoku
+ * @author  Bin Qu
+ * @date    2026.10.17
+ * @copyright   You can edit and remodify
+ * this file.
+*******************************************/
+
+#include "element.h"
+#include "solver.h"
+
+#include <vector>
+
+namespace sds
+{
+    /**
+     * Solver that models sudoku as an exact cover
+     * problem and runs Algorithm X on dancing links.
+     * Each row of the cover matrix places a digit into
+     * a lattice, each column is one of the constraints
+     * "lattice filled", "digit in row", "digit in column"
+     * and "digit in block".
+    */
+    class DLXSolver
+    {
+    private:
+        /**
+         * @brief links of nodes, node 0 is the root
+         * and nodes 1..column number are headers
+        */
+        std::vector<int> L, R, U, D;
+        /**
+         * @brief header of each node
+        */
+        std::vector<int> C;
+        /**
+         * @brief the number of nodes in each column
+        */
+        std::vector<int> S;
+        /**
+         * @brief the cover matrix row of each node
+        */
+        std::vector<int> rowOf;
+        /**
+         * @brief (lattice, digit) of each cover
+         * matrix row
+        */
+        std::vector<int> rowLattice, rowDigit;
+        /**
+         * @brief chosen nodes, one per depth
+        */
+        std::vector<int> choices;
+        /**
+         * @brief constraints satisfied by the clues, and the
+         * header of each other one, kept to be reused by
+         * the next build()
+        */
+        std::vector<bool> used;
+        std::vector<int> header;
+        /**
+         * @brief the number of visited search nodes
+        */
+        unsigned long nodes = 0;
+        /**
+         * @brief search stops once this many solutions
+         * are found
+        */
+        unsigned long limit = 1;
+        /**
+         * @brief the number of solutions found
+        */
+        unsigned long solutions = 0;
+        /**
+         * @brief called with each solution, may be nullptr
+        */
+        const SolutionCallback* onSolution = nullptr;
+
+        /**
+         * @brief add a node to a column and
+         * to the row started by first
+         * @return index of the node
+        */
+        int addNode(int column, int first);
+        /**
+         * @brief remove a column and the rows that
+         * intersect it
+        */
+        void cover(int column);
+        /**
+         * @brief undo cover()
+        */
+        void uncover(int column);
+        /**
+         * @brief build the cover matrix for the
+         * empty lattices of the grid
+         * @return false if the clues contradict
+        */
+        bool build(Grid& grid);
+        /**
+         * @brief write the chosen rows into the grid
+        */
+        void writeSolution(Grid& grid);
+        /**
+         * @brief run Algorithm X, going on after each exact
+         * cover until limit of them are found
+         * @param grid grid the matrix is built for
+         * @return have limit exact covers been found?
+        */
+        bool search(Grid& grid);
+
+    public:
+        /**
+         * @brief solve the grid, leaving the solution
+         * in it if there is any.
+         * @param grid grid loaded with clues
+         * @return is the grid solved?
+        */
+        bool solve(Grid& grid);
+        /**
+         * @brief search every branch and count solutions
+         * @param grid grid loaded with clues, holds the last
+         * solution found
+         * @param limit stop once this many are found
+         * @param onSolution called with each solution, may
+         * be nullptr
+         * @return the number of solutions, at most limit
+        */
+        unsigned long count(Grid& grid, unsigned long limit,
+            const SolutionCallback* onSolution);
+        /**
+         * @brief the number of search nodes visited by
+         * the last solve() or count()
+        */
+        unsigned long Nodes() { return nodes; }
+    };
+
+    int DLXSolver::addNode(int column, int first)
+    {
+        int node = (int)C.size();
+        C.push_back(column);
+        rowOf.push_back((int)rowLattice.size() - 1);
+        /* vertical: insert above the header */
+        U.push_back(U[column]);
+        D.push_back(column);
+        D[U[column]] = node;
+        U[column] = node;
+        S[column]++;
+        /* horizontal: insert before the first node */
+        if (first < 0)
+        {
+            L.push_back(node);
+            R.push_back(node);
+        }
+        else
+        {
+            L.push_back(L[first]);
+            R.push_back(first);
+            R[L[first]] = node;
+            L[first] = node;
+        }
+        return node;
+    }
+
+    void DLXSolver::cover(int column)
+    {
+        R[L[column]] = R[column];
+        L[R[column]] = L[column];
+        for (int i = D[column]; i != column; i = D[i])
+            for (int j = R[i]; j != i; j = R[j])
+            {
+                D[U[j]] = D[j];
+                U[D[j]] = U[j];
+                S[C[j]]--;
+            }
+    }
+
+    void DLXSolver::uncover(int column)
+    {
+        for (int i = U[column]; i != column; i = U[i])
+            for (int j = L[i]; j != i; j = L[j])
+            {
+                S[C[j]]++;
+                D[U[j]] = j;
+                U[D[j]] = j;
+            }
+        R[L[column]] = column;
+        L[R[column]] = column;
+    }
+
+    bool DLXSolver::build(Grid& grid)
+    {
+        const unsigned int length = grid.Length();
+        const unsigned int blocklength = grid.BlockLength();
+        const unsigned int sizegrid = grid.Size();
+        /* constraints satisfied by the clues */
+        used.assign(4 * sizegrid, false);
+        for (unsigned int i = 0; i < sizegrid; i++)
+        {
+            int digit = grid(i / length, i % length);
+            if (digit == 0)
+                continue;
+            if (digit < 0 || (unsigned int)digit > length)
+                return false;
+            unsigned int row = i / length;
+            unsigned int col = i % length;
+            unsigned int block = (row / blocklength) * blocklength +
+                col / blocklength;
+            unsigned int keys[4] = {
+                i,
+                sizegrid + row * length + digit - 1,
+                2 * sizegrid + col * length + digit - 1,
+                3 * sizegrid + block * length + digit - 1};
+            for (unsigned int k = 0; k < 4; k++)
+            {
+                if (used[keys[k]])
+                    return false;
+                used[keys[k]] = true;
+            }
+        }
+
+        /* headers of unsatisfied constraints */
+        header.assign(4 * sizegrid, 0);
+        int columns = 0;
+        for (unsigned int k = 0; k < 4 * sizegrid; k++)
+            if (!used[k])
+                header[k] = ++columns;
+        L.assign(columns + 1, 0);
+        R.assign(columns + 1, 0);
+        U.resize(columns + 1);
+        D.resize(columns + 1);
+        C.assign(columns + 1, 0);
+        S.assign(columns + 1, 0);
+        rowOf.assign(columns + 1, -1);
+        for (int c = 0; c <= columns; c++)
+        {
+            L[c] = c == 0 ? columns : c - 1;
+            R[c] = c == columns ? 0 : c + 1;
+            U[c] = c;
+            D[c] = c;
+            C[c] = c;
+        }
+        rowLattice.clear();
+        rowDigit.clear();
+
+        /* a row for each candidate of each empty lattice */
+        for (unsigned int i = 0; i < sizegrid; i++)
+        {
+            if (grid(i / length, i % length) != 0)
+                continue;
+            unsigned int row = i / length;
+            unsigned int col = i % length;
+            unsigned int block = (row / blocklength) * blocklength +
+                col / blocklength;
+            for (unsigned int digit = 1; digit <= length; digit++)
+            {
+                unsigned int keys[4] = {
+                    i,
+                    sizegrid + row * length + digit - 1,
+                    2 * sizegrid + col * length + digit - 1,
+                    3 * sizegrid + block * length + digit - 1};
+                if (used[keys[1]] || used[keys[2]] || used[keys[3]])
+                    continue;
+                rowLattice.push_back(i);
+                rowDigit.push_back(digit);
+                int first = -1;
+                for (unsigned int k = 0; k < 4; k++)
+                {
+                    int node = addNode(header[keys[k]], first);
+                    if (first < 0)
+                        first = node;
+                }
+            }
+        }
+        return true;
+    }
+
+    void DLXSolver::writeSolution(Grid& grid)
+    {
+        const unsigned int length = grid.Length();
+        for (unsigned int k = 0; k < choices.size(); k++)
+        {
+            int lattice = rowLattice[rowOf[choices[k]]];
+            grid(lattice / length, lattice % length) =
+                rowDigit[rowOf[choices[k]]];
+        }
+    }
+
+    bool DLXSolver::search(Grid& grid)
+    {
+        choices.clear();
+        bool isForward = true;
+        int column = 0;
+        int row;
+        while (true)
+        {
+            if (isForward)
+            {
+                nodes++;
+                if (R[0] == 0)
+                {
+                    solutions++;
+                    writeSolution(grid);
+                    if (onSolution != nullptr)
+                        (*onSolution)(grid.Lattices());
+                    if (solutions >= limit)
+                        return true;
+                    /* nothing was covered here, try the next row */
+                    isForward = false;
+                    continue;
+                }
+                /* choose the column with the fewest rows */
+                column = R[0];
+                for (int c = R[column]; c != 0 && S[column] > 1; c = R[c])
+                    if (S[c] < S[column])
+                        column = c;
+                cover(column);
+                row = D[column];
+            }
+            else
+            {
+                if (choices.empty())
+                    return false;
+                row = choices.back();
+                choices.pop_back();
+                for (int j = L[row]; j != row; j = L[j])
+                    uncover(C[j]);
+                column = C[row];
+                row = D[row];
+            }
+
+            if (row == column)
+            {
+                /* no row left in this column, backtrack */
+                uncover(column);
+                isForward = false;
+                continue;
+            }
+            choices.push_back(row);
+            for (int j = R[row]; j != row; j = R[j])
+                cover(C[j]);
+            isForward = true;
+        }
+    }
+
+    bool DLXSolver::solve(Grid& grid)
+    { return count(grid, 1, nullptr) == 1; }
+
+    unsigned long DLXSolver::count(Grid& grid, unsigned long limit,
+        const SolutionCallback* onSolution)
+    {
+        nodes = 0;
+        solutions = 0;
+        this->limit = limit;
+        this->onSolution = onSolution;
+        if (!build(grid))
+            return 0;
+        search(grid);
+        return solutions;
+    }
+}
\ No newline at end of file
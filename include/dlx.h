@@ -0,0 +1,4 @@
+#ifndef DLX_H
+#define DLX_H
+#include "dlx.cxx"
+#endif
\ No newline at end of file
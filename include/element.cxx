@@ -7,9 +7,17 @@
  * this file.
 *******************************************/
 
+#include "bits.h"
+#include "simd.h"
+#include "stats.h"
+#include "trace.h"
+
 #include <cstdio>
 #include <cstdlib>
+#include <cstring>
 #include <map>
+#include <string>
+#include <utility>
 
 /// namespace sudoku solver
 namespace sds
@@ -38,7 +46,7 @@ typedef unsigned char byte;
         /**
          * @brief the length of a byte (bit)
         */
-        const byte len_byte = 8;
+        static constexpr byte len_byte = 8;
 
         /**
          * @brief get upper bound
@@ -46,6 +54,13 @@ typedef unsigned char byte;
         static inline byte my_ceil(byte a, byte b)
         { return (a + b - 1) / b; }
 
+        /**
+         * @brief set a buffer mask to "every digit
+         * is a candidate".
+         * @param buf_mask buffer with mask_cell_len bytes
+        */
+        inline void resetBufMask(byte* buf_mask);
+
         /**
          * @brief grid size length
         */
@@ -54,6 +69,147 @@ typedef unsigned char byte;
          * @brief length of block
         */
         unsigned int blocklength;
+        /**
+         * @brief the number of lattices allocated
+        */
+        unsigned int lat_capacity;
+        /**
+         * @brief the number of mask bytes allocated
+        */
+        unsigned int mask_capacity;
+        /**
+         * @brief trace progress and fillings?
+        */
+        bool isVerbose = true;
+        /**
+         * @brief counters of the rules, nullptr when
+         * nobody asked for them
+        */
+        SolveStats* stats = nullptr;
+        /**
+         * @brief peers (other lattices of the same row,
+         * column or block) of every lattice, peer_len
+         * per lattice
+        */
+        unsigned short* peers;
+        /**
+         * @brief the number of peers of a lattice
+        */
+        unsigned int peer_len;
+        /**
+         * @brief the number of peer entries allocated
+        */
+        unsigned int peer_capacity;
+        /**
+         * @brief grid size length peers are built for
+        */
+        unsigned int peer_length;
+        /**
+         * @brief empty lattices left with a single
+         * candidate, waiting for fill()
+        */
+        unsigned int* singles;
+        /**
+         * @brief the number of queued lattices
+        */
+        unsigned int singles_len;
+        /**
+         * @brief the number of queue entries allocated
+        */
+        unsigned int singles_capacity;
+        /**
+         * @brief has an empty lattice run out of candidates?
+        */
+        bool isDead;
+        /**
+         * @brief scratch of initializeMask(): row, column
+         * and block masks and one row of lattice masks,
+         * length * mask_cell_len bytes each
+        */
+        byte* unit_mask;
+        /**
+         * @brief the number of scratch bytes allocated
+        */
+        unsigned int unit_mask_capacity;
+        /**
+         * @brief a byte of mask (index < mask_len), of
+         * lattices (index - mask_len) or a slot of the singles
+         * queue (index - mask_len - Size()) before it was changed
+        */
+        struct TrailEntry
+        {
+            unsigned int index;
+            unsigned int value;
+        };
+        /**
+         * @brief changes made since the outermost open mark,
+         * oldest first
+        */
+        TrailEntry* trail;
+        /**
+         * @brief the number of recorded changes
+        */
+        unsigned int trail_len;
+        /**
+         * @brief the number of trail entries allocated
+        */
+        unsigned int trail_capacity;
+        /**
+         * @brief the number of open marks, changes are
+         * only recorded while there is one
+        */
+        unsigned int trail_depth;
+
+        /**
+         * @brief record a byte of mask before changing it
+         * @param k index into mask
+        */
+        inline void trailMask(const unsigned int& k);
+        /**
+         * @brief append an entry to the trail, growing it
+        */
+        void pushTrail(const unsigned int& index, const unsigned int& value);
+
+        /**
+         * @brief clear the bit of every digit placed in
+         * count lattices, starting at first, step apart
+         * @param buf_mask mask to clear bits from
+        */
+        inline void clearPlacedBits(byte* buf_mask, unsigned int first,
+            unsigned int step, unsigned int count);
+
+        /**
+         * @brief copy the shape and the state of another
+         * grid, reusing memory if it is large enough
+        */
+        void copyFrom(const Grid& other);
+        /**
+         * @brief exchange buffers and state with another grid
+        */
+        void swap(Grid& other);
+        /**
+         * @brief build peer lists for the current shape
+        */
+        void buildPeers();
+        /**
+         * @brief get the digit of a lattice that has a
+         * single candidate
+         * @param i 1-d address
+         * @return the digit, or 0 if there are zero or
+         * several candidates
+        */
+        unsigned int singleDigit(const unsigned int& i);
+        /**
+         * @brief queue a lattice if it is left with a single
+         * candidate, mark the grid dead if with none
+         * @param i 1-d address of an empty lattice
+        */
+        inline void checkLattice(const unsigned int& i);
+        /**
+         * @brief rebuild the queue of single-candidate
+         * lattices and the dead flag from scratch
+        */
+        void scanSingles();
     public:
         const unsigned int& Length() {return length;}
         unsigned int Size() {return length * length;}
@@ -63,6 +219,22 @@ typedef unsigned char byte;
 
         unsigned int BlockSize()
         { return blocklength * blocklength; }
+
+        /**
+         * @brief row-major lattices, 0 represents "empty"
+        */
+        const char* Lattices() { return lattices; }
+
+        /**
+         * @brief the number of bytes a state snapshot
+         * of lattices takes
+        */
+        unsigned int LatticeBytes() { return Size(); }
+        /**
+         * @brief the number of bytes a state snapshot
+         * of mask takes
+        */
+        unsigned int MaskBytes() { return mask_len; }
         
         /**
          * @brief map block address to lattice
@@ -128,7 +300,9 @@ typedef unsigned char byte;
             unsigned int block_x);
         /**
          * @brief fill blanks that only conains one
-         * candidate.
+         * candidate. Only lattices queued since the last
+         * call are visited, and fillings queue new ones
+         * until none is left.
          * @return is update?
         */
         bool fill();
@@ -139,20 +313,160 @@ typedef unsigned char byte;
         bool isCompleted();
         /**
          * @brief use i-excluding algorithm to further modify
-         * mask.
+         * mask: if k <= ie lattices of a unit have only k
+         * candidates between them (a naked subset), remove
+         * those candidates from the rest of the unit.
          * @param i how many bits are referenced?
          * @return is any update?
         */
         bool excluding(const unsigned int& ie);
+        /**
+         * @brief i-excluding that also reports where it
+         * made progress.
+         * @param ie the largest subset size
+         * @param changed output units (see unitLattice()) in
+         * which candidates were removed, at least 3n entries,
+         * may be nullptr
+         * @param changed_len output the number of changed units
+         * @return is any update?
+        */
+        bool excluding(const unsigned int& ie, unsigned int* changed,
+            unsigned int* changed_len);
+        /**
+         * @brief hidden subsets: if k <= ie digits of a unit
+         * can only go into the same k lattices, remove every
+         * other candidate from those lattices. ie = 1 finds
+         * hidden singles, which are then queued for fill().
+         * @param ie the largest subset size
+         * @return is any update?
+        */
+        bool hiding(const unsigned int& ie);
+        /**
+         * @brief map a unit to a lattice
+         * @param unit rows are 0..n-1, columns n..2n-1,
+         * blocks 2n..3n-1
+         * @param k index inside the unit
+         * @return 1-d address
+        */
+        unsigned int unitLattice(const unsigned int& unit,
+            const unsigned int& k);
+        /**
+         * @brief write a digit into an empty lattice and
+         * remove it from the candidates of the lattice's
+         * peers. Peers left with a single candidate are
+         * queued for fill().
+         * @param i 1-d address
+         * @param digit digit to write
+        */
+        void place(const unsigned int& i, const byte& digit);
+        /**
+         * @brief count candidates of a lattice
+         * @param i 1-d address
+         * @return the number of candidated digits
+        */
+        unsigned int countCandidates(const unsigned int& i);
+        /**
+         * @brief judge if an empty lattice has run out of
+         * candidates, which means the grid cannot be solved.
+         * @return is there any dead lattice?
+        */
+        bool hasDeadLattice();
+        /**
+         * @brief a point of the trail to roll back to
+        */
+        struct TrailMark
+        {
+            unsigned int position;
+            unsigned int singles_len;
+            bool isDead;
+        };
+        /**
+         * @brief start recording changes, so that undo() can
+         * restore the grid as it is now. Marks nest, and each
+         * one must be released. Only the bytes that change are
+         * recorded, the trail grows to the deepest branch once
+         * and is reused.
+         * @return the mark to pass to undo() and release()
+        */
+        TrailMark mark();
+        /**
+         * @brief roll lattices and mask back to a mark, which
+         * stays open
+        */
+        void undo(const TrailMark& mark);
+        /**
+         * @brief close the newest mark, keeping the changes
+         * made since
+        */
+        void release();
+        /**
+         * @brief copy lattices and mask out
+         * @param lat_buf buffer with LatticeBytes() bytes
+         * @param mask_buf buffer with MaskBytes() bytes
+        */
+        void saveState(char* lat_buf, byte* mask_buf);
+        /**
+         * @brief copy lattices and mask back
+         * @param lat_buf buffer filled by saveState()
+         * @param mask_buf buffer filled by saveState()
+        */
+        void loadState(const char* lat_buf, const byte* mask_buf);
         /**
          * @brief display grid
         */
         void dispGrid();
+        /**
+         * @brief reshape the grid and clear it. Memory
+         * is reused if it is large enough.
+         * @param length grid size length
+         * @param blocklength length of block
+        */
+        void resize(const unsigned int& length,
+            const unsigned int& blocklength);
+        /**
+         * @brief load clues and reset mask, so that
+         * a grid can be reused for another sudoku.
+         * @param digits Size() digits, 0 represents "empty"
+        */
+        void load(const char* digits);
+        /**
+         * @brief turn tracing of this grid's progress
+         * on or off
+        */
+        void setVerbose(bool verbose) { isVerbose = verbose; }
+        /**
+         * @brief count the work of the rules into stats,
+         * nullptr to stop counting
+        */
+        void setStats(SolveStats* stats) { this->stats = stats; }
+        /**
+         * @brief stats attached by setStats()
+        */
+        SolveStats* Stats() { return stats; }
         /**
          * @brief constructor that allocates
          * memory
         */
         Grid(const unsigned int& length, const unsigned int& blocklength);
+        /**
+         * @brief deep copy, including mask and the queue
+         * of single-candidate lattices
+        */
+        Grid(const Grid& other);
+        /**
+         * @brief take the buffers of another grid, which
+         * is left as an empty 0x0 grid
+        */
+        Grid(Grid&& other) noexcept;
+        /**
+         * @brief deep copy, buffers of this grid are reused
+         * if they are large enough
+        */
+        Grid& operator=(const Grid& other);
+        /**
+         * @brief exchange buffers with another grid
+        */
+        Grid& operator=(Grid&& other) noexcept;
         /**
          * @brief deconstructor that frees
          * memory
@@ -163,6 +477,7 @@ typedef unsigned char byte;
     inline void Grid::setMaskBit(const unsigned int& i, const byte& digit,
             const bool& candidate)
     {
+        trailMask(i * mask_cell_len + (my_ceil(digit, len_byte) - 1));
         if (candidate)
             mask[i * mask_cell_len +
                 (my_ceil(digit, len_byte) - 1)] |=
@@ -170,232 +485,365 @@ typedef unsigned char byte;
         else
             mask[i * mask_cell_len +
                 (my_ceil(digit, len_byte) - 1)] &=
-                (0xFE << ((digit - 1) % len_byte));
+                ~(0x01 << ((digit - 1) % len_byte));
+    }
+
+    inline void Grid::resetBufMask(byte* buf_mask)
+    {
+        for (int i = 0; i < mask_cell_len; i++)
+            buf_mask[i] = 0xFF;
+        /* clear the bits beyond the last digit */
+        if (length % len_byte != 0)
+            buf_mask[mask_cell_len - 1] >>= len_byte - length % len_byte;
+    }
+
+    inline void Grid::clearPlacedBits(byte* buf_mask, unsigned int first,
+        unsigned int step, unsigned int count)
+    {
+        for (unsigned int k = 0; k < count; k++)
+        {
+            const char digit = lattices[first + k * step];
+            if (digit != 0)
+                buf_mask[my_ceil(digit, len_byte) - 1] &=
+                    ~(0x01 << ((digit - 1) % len_byte));
+        }
     }
 
     void Grid::initializeMask()
     {
-        byte buf_mask[mask_cell_len];
-        /* scan lattice */
-        /* row scan */
-        std::printf("initialize row mask...\r\n");
-        for (int row = 1; row <= length; row++)
+        const MaskKernels& kernels = maskKernels();
+        /* a rebuild touches every byte */
+        for (unsigned int k = 0; k < mask_len && trail_depth != 0; k++)
+            pushTrail(k, mask[k]);
+        const unsigned int line_len = length * mask_cell_len;
+        byte* row_mask = unit_mask;
+        byte* col_mask = unit_mask + line_len;
+        byte* block_mask = unit_mask + 2 * line_len;
+        byte* line = unit_mask + 3 * line_len;
+        if (stats != nullptr)
+            stats->initialize_mask++;
+        /* build row, column and block masks in one scan */
+        if (isVerbose)
+            SDS_TRACE(trace_info,
+                "initialize row, column and block mask (%s)...\r\n",
+                kernels.name);
+        for (unsigned int unit = 0; unit < 3 * length; unit++)
+            resetBufMask(unit_mask + unit * mask_cell_len);
+        const unsigned int sizegrid = Size();
+        for (unsigned int i = 0; i < sizegrid; i++)
         {
-            /* initialize buffer mask */
-            for (int i = 0; i < mask_cell_len; i++)
-            {
-                buf_mask[i] = 0xFF;
-                if (i == mask_cell_len - 1)
-                    buf_mask[i] >>= len_byte - length % len_byte;
-            }
+            const char digit = lattices[i];
+            if (digit == 0)
+                continue;
+            const unsigned int row = i / length;
+            const unsigned int col = i % length;
+            const unsigned int block = row / blocklength * blocklength +
+                col / blocklength;
+            const unsigned int j = my_ceil(digit, len_byte) - 1;
+            const byte bit = ~(0x01 << ((digit - 1) % len_byte));
+            row_mask[row * mask_cell_len + j] &= bit;
+            col_mask[col * mask_cell_len + j] &= bit;
+            block_mask[block * mask_cell_len + j] &= bit;
+        }
 
-            /* modify buffer mask */
-            for (int i = (row - 1) * length;
-                i < row * length; i++)
-                if (lattices[i] != 0)
-                    buf_mask[my_ceil(lattices[i], len_byte) - 1] &=
-                        ~(0x01 << ((lattices[i] - 1) % len_byte));
-                
-            /* set mask (I suggest to vectorize this loop) */
-            for (int i = (row - 1) * length * mask_cell_len;
-                i < row * length * mask_cell_len; i++)
-                    mask[i] &= buf_mask[i % mask_cell_len];
+        /* a row of lattices sees the column masks side by side,
+        so every row is a few contiguous vector ANDs */
+        for (unsigned int row = 0; row < length; row++)
+        {
+            std::memcpy(line, col_mask, line_len);
+            kernels.andPattern(line, row_mask + row * mask_cell_len,
+                mask_cell_len, length);
+            const unsigned int block_row = row / blocklength * blocklength;
+            for (unsigned int bx = 0; bx < blocklength; bx++)
+                kernels.andPattern(line + bx * blocklength * mask_cell_len,
+                    block_mask + (block_row + bx) * mask_cell_len,
+                    mask_cell_len, blocklength);
+            kernels.andBytes(mask + row * line_len, line, line_len);
         }
 
-        /* column scan */
-        std::printf("initialize column mask...\r\n");
-        /* use scalar to help implement parallelism */
-        const unsigned int sizegrid = Size();
-        for (int col = 1; col <= length; col++)
+        /* scan where mask should be 0 */
+        for (unsigned int i = 0; i < sizegrid; i++)
+            if (lattices[i] != 0)
+                std::memset(mask + i * mask_cell_len, 0, mask_cell_len);
+
+        /* queue lattices that can be filled */
+        scanSingles();
+    }
+
+    void Grid::buildPeers()
+    {
+        peer_len = 3 * length - 2 * blocklength - 1;
+        if (peer_length == length)
+            return;
+        if (Size() * peer_len > peer_capacity)
+        {
+            peers = (unsigned short*)std::realloc(peers,
+                Size() * peer_len * sizeof(unsigned short));
+            peer_capacity = Size() * peer_len;
+        }
+        for (unsigned int i = 0; i < Size(); i++)
         {
-            /* initialize buffer mask */
-            for (int i = 0; i < mask_cell_len; i++)
+            const unsigned int row = i / length;
+            const unsigned int col = i % length;
+            const unsigned int block_y = (row / blocklength) * blocklength;
+            const unsigned int block_x = (col / blocklength) * blocklength;
+            unsigned short* p = peers + i * peer_len;
+            for (unsigned int k = 0; k < length; k++)
             {
-                buf_mask[i] = 0xFF;
-                if (i == mask_cell_len - 1)
-                    buf_mask[i] >>= len_byte - length % len_byte;
+                if (k != col)
+                    *p++ = row * length + k;
+                if (k != row)
+                    *p++ = k * length + col;
             }
-                
-            /* modify buffer mask */
-            for (int i = col - 1; i < sizegrid - length + col;
-                i += length)
-                if (lattices[i] != 0)
-                    buf_mask[my_ceil(lattices[i], len_byte) - 1] &=
-                        ~(0x01 << ((lattices[i] - 1) % len_byte));
-                
-            /* set mask */
-            for (int i = col - 1; i < sizegrid - length + col;
-                i += length)
-                for (int j = 0; j < mask_cell_len; j++)
-                    mask[i * mask_cell_len + j] &= buf_mask[j];
+            /* block lattices out of the row and the column */
+            for (unsigned int y = block_y; y < block_y + blocklength; y++)
+                for (unsigned int x = block_x; x < block_x + blocklength; x++)
+                    if (y != row && x != col)
+                        *p++ = y * length + x;
         }
-            
-        /* block scan */
-        std::printf("initialize block mask...\r\n");
-        for (int block_y = 1; block_y <= blocklength; block_y++)
-            for (int block_x = 1; block_x <= blocklength; block_x++)
-            {
-                /* initialize buffer mask */
-                for (int i = 0; i < mask_cell_len; i++)
+        peer_length = length;
+    }
+
+    unsigned int Grid::singleDigit(const unsigned int& i)
+    {
+        unsigned int digit = 0;
+        for (int j = 0; j < mask_cell_len; j++)
+        {
+            byte tmpMask = mask[i * mask_cell_len + j];
+            if (tmpMask == 0)
+                continue;
+            if ((tmpMask & (tmpMask - 1)) != 0 || digit != 0)
+                return 0;
+            for (int k = 0; k < len_byte; k++)
+                if (tmpMask == (1 << k))
                 {
-                    buf_mask[i] = 0xFF;
-                    if (i == mask_cell_len - 1)
-                        buf_mask[i] >>= len_byte - length % len_byte;
+                    digit = (k + 1) + j * len_byte;
+                    break;
                 }
-                    
-                /* modify buffer mask */
-                for (int i = (block_y - 1) * blocklength;
-                    i < block_y * blocklength; i++)
-                    for (int j = (block_x - 1) * blocklength;
-                        j < block_x * blocklength; j++)
-                    {
-                        unsigned int k = i * length + j;
-                        if (lattices[k] != 0)
-                            buf_mask[my_ceil(lattices[k], len_byte) - 1] &=
-                                ~(0x01 << ((lattices[k] - 1) % len_byte));
-                    }
+        }
+        return digit;
+    }
 
-                /* set mask */
-                for (int i = (block_y - 1) * blocklength;
-                    i < block_y * blocklength; i++)
-                    for (int j = (block_x - 1) * blocklength;
-                        j < block_x * blocklength; j++)
-                        for (int k = 0; k < mask_cell_len; k++)
-                            mask[i * length * mask_cell_len +
-                                    j * mask_cell_len + k] &= buf_mask[k];
-            }
+    inline void Grid::checkLattice(const unsigned int& i)
+    {
+        unsigned int bitcounter = 0;
+        for (int j = 0; j < mask_cell_len && bitcounter < 2; j++)
+        {
+            byte tmpMask = mask[i * mask_cell_len + j];
+            if (tmpMask != 0)
+                bitcounter += (tmpMask & (tmpMask - 1)) == 0 ? 1 : 2;
+        }
+        if (bitcounter == 1)
+        {
+            /* the slot may hold a lattice popped after a mark */
+            if (trail_depth != 0)
+                pushTrail(mask_len + Size() + singles_len,
+                    singles[singles_len]);
+            singles[singles_len++] = i;
+        }
+        else if (bitcounter == 0)
+            isDead = true;
+    }
 
-        /* scan where mask should be 0 */
-        for (int i = 0; i < sizegrid; i++)
-            if (lattices[i] != 0)
-                for (int j = 0; j < mask_cell_len; j++)
-                    mask[i * mask_cell_len + j] = 0;
+    void Grid::scanSingles()
+    {
+        singles_len = 0;
+        isDead = false;
+        const unsigned int sizegrid = Size();
+        for (unsigned int i = 0; i < sizegrid; i++)
+            if (lattices[i] == 0)
+                checkLattice(i);
     }
     
     void Grid::update_row_mask(unsigned int row)
     {
         byte buf_mask[mask_cell_len];
         /* initialize buffer mask */
-        for (int i = 0; i < mask_cell_len; i++)
-        {
-            buf_mask[i] = 0xFF;
-            if (i == mask_cell_len - 1)
-                buf_mask[i] >>= len_byte - length % len_byte;
-        }
+        resetBufMask(buf_mask);
         /* modify buffer mask */
-        for (int i = (row - 1) * length;
-            i < row * length; i++)
-            if (lattices[i] != 0)
-                buf_mask[my_ceil(lattices[i], len_byte) - 1] &=
-                    ~(0x01 << ((lattices[i] - 1) % len_byte));
-                
-        /* set mask (I suggest to vectorize this loop) */
-        for (int i = (row - 1) * length * mask_cell_len;
-            i < row * length * mask_cell_len; i++)
-                mask[i] &= buf_mask[i % mask_cell_len];
+        clearPlacedBits(buf_mask, (row - 1) * length, 1, length);
+        /* set mask */
+        for (unsigned int k = 0; k < length * mask_cell_len &&
+            trail_depth != 0; k++)
+            trailMask((row - 1) * length * mask_cell_len + k);
+        maskKernels().andPattern(mask + (row - 1) * length * mask_cell_len,
+            buf_mask, mask_cell_len, length);
     }
 
     void Grid::update_col_mask(unsigned int col)
     {
         byte buf_mask[mask_cell_len];
-        const unsigned int sizegrid = Size();
         /* initialize buffer mask */
-        for (int i = 0; i < mask_cell_len; i++)
-        {
-            buf_mask[i] = 0xFF;
-            if (i == mask_cell_len - 1)
-                buf_mask[i] >>= len_byte - length % len_byte;
-        }
-                
+        resetBufMask(buf_mask);
         /* modify buffer mask */
-        for (int i = col - 1; i < sizegrid - length + col;
-            i += length)
-            if (lattices[i] != 0)
-                buf_mask[my_ceil(lattices[i], len_byte) - 1] &=
-                    ~(0x01 << ((lattices[i] - 1) % len_byte));
-                
+        clearPlacedBits(buf_mask, col - 1, length, length);
         /* set mask */
-        for (int i = col - 1; i < sizegrid - length + col;
-            i += length)
-            for (int j = 0; j < mask_cell_len; j++)
-                mask[i * mask_cell_len + j] &= buf_mask[j];
+        for (unsigned int k = 0; k < length && trail_depth != 0; k++)
+            for (unsigned int j = 0; j < mask_cell_len; j++)
+                trailMask((k * length + col - 1) * mask_cell_len + j);
+        andStrided(mask + (col - 1) * mask_cell_len,
+            length * mask_cell_len, length, buf_mask, mask_cell_len);
     }
 
     void Grid::update_block_mask(unsigned int block_y,
         unsigned int block_x)
     {
         byte buf_mask[mask_cell_len];
+        const unsigned int first = (block_y - 1) * blocklength * length +
+            (block_x - 1) * blocklength;
         /* initialize buffer mask */
-        for (int i = 0; i < mask_cell_len; i++)
-        {
-            buf_mask[i] = 0xFF;
-            if (i == mask_cell_len - 1)
-                buf_mask[i] >>= len_byte - length % len_byte;
-        }
-                    
+        resetBufMask(buf_mask);
         /* modify buffer mask */
-        for (int i = (block_y - 1) * blocklength;
-            i < block_y * blocklength; i++)
-            for (int j = (block_x - 1) * blocklength;
-                j < block_x * blocklength; j++)
-            {
-                unsigned int k = i * length + j;
-                if (lattices[k] != 0)
-                    buf_mask[my_ceil(lattices[k], len_byte) - 1] &=
-                        ~(0x01 << ((lattices[k] - 1) % len_byte));
-            }
-
-        /* set mask */
-        for (int i = (block_y - 1) * blocklength;
-            i < block_y * blocklength; i++)
-            for (int j = (block_x - 1) * blocklength;
-                j < block_x * blocklength; j++)
-                for (int k = 0; k < mask_cell_len; k++)
-                    mask[i * length * mask_cell_len +
-                        j * mask_cell_len + k] &= buf_mask[k];
+        for (unsigned int i = 0; i < blocklength; i++)
+            clearPlacedBits(buf_mask, first + i * length, 1, blocklength);
+        /* set mask, a block row at a time */
+        for (unsigned int i = 0; i < blocklength && trail_depth != 0; i++)
+            for (unsigned int k = 0; k < blocklength * mask_cell_len; k++)
+                trailMask((first + i * length) * mask_cell_len + k);
+        for (unsigned int i = 0; i < blocklength; i++)
+            maskKernels().andPattern(mask + (first + i * length) *
+                mask_cell_len, buf_mask, mask_cell_len, blocklength);
     }
 
     bool Grid::fill()
     {
-        /* traversing lefttop to rightdown */
-        const unsigned int sizegrid = length * length;
-        byte tmpMask;
+        /* only lattices queued by place() or excluding() can be filled */
         unsigned int tmpLat;
-        bool canFill;
         bool isUpdated = false;
-        for (int i = 0; i < sizegrid; i++)
+        while (singles_len > 0)
         {
-            if (lattices[i] == 0)
+            const unsigned int i = singles[--singles_len];
+            if (lattices[i] != 0)
+                continue;
+            /* it may have lost its last candidate meanwhile */
+            tmpLat = singleDigit(i);
+            if (tmpLat == 0)
+                continue;
+            if (isVerbose)
+                SDS_TRACE(trace_debug, "Fill row %ld, col %ld with %ld\r\n",
+                    (long)(i / length + 1), (long)(i % length + 1), (long)tmpLat);
+            place(i, tmpLat);
+            isUpdated = true;
+            if (stats != nullptr)
+                stats->placements++;
+        }
+        if (stats != nullptr)
+        {
+            stats->fill_calls++;
+            stats->fill_passes += isUpdated;
+        }
+        return isUpdated;
+    }
+
+    void Grid::place(const unsigned int& i, const byte& digit)
+    {
+        const unsigned int byteIdx = my_ceil(digit, len_byte) - 1;
+        const byte bit = 0x01 << ((digit - 1) % len_byte);
+        if (trail_depth != 0)
+            pushTrail(mask_len + i, lattices[i]);
+        lattices[i] = digit;
+        for (int j = 0; j < mask_cell_len; j++)
+            if (mask[i * mask_cell_len + j] != 0)
             {
-                tmpLat = 0;
-                canFill = true;
-                for (int j = 0; j < mask_cell_len && canFill; j++)
-                    for (int k = 0; k < len_byte; k++)
-                        if (mask[i * mask_cell_len + j] == (1 << k))
-                        {
-                            tmpLat += (k + 1) + j * len_byte;
-                            canFill = true;
-                            break;
-                        }
-                        else if (mask[i * mask_cell_len + j] != 0)
-                            canFill = false;
-                /* check tmpLat */
-                if (tmpLat <= length && tmpLat >= 1)
-                {
-                    lattices[i] = tmpLat;
-                    std::printf("Fill row %d, col %d with %d\r\n",
-                        i / length + 1, i % length + 1, tmpLat);
-                    update_row_mask( i / length + 1);
-                    update_col_mask(i % length + 1);
-                    update_block_mask((i / length) / blocklength + 1,
-                        (i % length) / blocklength + 1);
-                    for (int j = 0; j < mask_cell_len; j++)
-                        mask[i * mask_cell_len + j] = 0;
-                    isUpdated = true;
-                }
+                trailMask(i * mask_cell_len + j);
+                mask[i * mask_cell_len + j] = 0;
             }
+        /* remove the digit from peers only */
+        const unsigned short* p = peers + i * peer_len;
+        unsigned int updates = 0;
+        for (unsigned int k = 0; k < peer_len; k++)
+        {
+            byte& tmpMask = mask[p[k] * mask_cell_len + byteIdx];
+            if ((tmpMask & bit) == 0)
+                continue;
+            trailMask(p[k] * mask_cell_len + byteIdx);
+            tmpMask &= ~bit;
+            updates++;
+            if (lattices[p[k]] == 0)
+                checkLattice(p[k]);
         }
-        return isUpdated;
+        if (stats != nullptr)
+            stats->peer_updates += updates;
+    }
+
+    unsigned int Grid::countCandidates(const unsigned int& i)
+    {
+        unsigned int bitcounter = 0;
+        for (int j = 0; j < mask_cell_len; j++)
+            for (byte tmpMask = mask[i * mask_cell_len + j]; tmpMask != 0;
+                tmpMask &= tmpMask - 1)
+                bitcounter++;
+        return bitcounter;
+    }
+
+    bool Grid::hasDeadLattice()
+    { return isDead; }
+
+    void Grid::saveState(char* lat_buf, byte* mask_buf)
+    {
+        std::memcpy(lat_buf, lattices, Size() * sizeof(char));
+        std::memcpy(mask_buf, mask, mask_len * sizeof(byte));
+    }
+
+    void Grid::loadState(const char* lat_buf, const byte* mask_buf)
+    {
+        for (unsigned int k = 0; k < mask_len && trail_depth != 0; k++)
+            pushTrail(k, mask[k]);
+        for (unsigned int i = 0; i < Size() && trail_depth != 0; i++)
+            pushTrail(mask_len + i, lattices[i]);
+        std::memcpy(lattices, lat_buf, Size() * sizeof(char));
+        std::memcpy(mask, mask_buf, mask_len * sizeof(byte));
+        scanSingles();
+    }
+
+    inline void Grid::trailMask(const unsigned int& k)
+    {
+        if (trail_depth != 0)
+            pushTrail(k, mask[k]);
+    }
+
+    void Grid::pushTrail(const unsigned int& index, const unsigned int& value)
+    {
+        if (trail_len == trail_capacity)
+        {
+            trail_capacity = trail_capacity == 0 ? 1024 : 2 * trail_capacity;
+            trail = (TrailEntry*)std::realloc(trail,
+                trail_capacity * sizeof(TrailEntry));
+        }
+        trail[trail_len].index = index;
+        trail[trail_len].value = value;
+        trail_len++;
+    }
+
+    Grid::TrailMark Grid::mark()
+    {
+        trail_depth++;
+        return TrailMark{trail_len, singles_len, isDead};
+    }
+
+    void Grid::undo(const TrailMark& mark)
+    {
+        /* newest first, so a byte changed twice ends up oldest */
+        while (trail_len > mark.position)
+        {
+            const TrailEntry& entry = trail[--trail_len];
+            if (entry.index < mask_len)
+                mask[entry.index] = (byte)entry.value;
+            else if (entry.index < mask_len + Size())
+                lattices[entry.index - mask_len] = (char)entry.value;
+            else
+                singles[entry.index - mask_len - Size()] = entry.value;
+        }
+        isDead = mark.isDead;
+        singles_len = mark.singles_len;
+    }
+
+    void Grid::release()
+    {
+        trail_depth--;
+        /* nobody can roll back any more */
+        if (trail_depth == 0)
+            trail_len = 0;
     }
 
     bool Grid::isCompleted()
@@ -409,7 +857,13 @@ typedef unsigned char byte;
     }
 
     bool Grid::excluding(const unsigned int& ie)
+    { return excluding(ie, nullptr, nullptr); }
+
+    bool Grid::excluding(const unsigned int& ie, unsigned int* changed,
+        unsigned int* changed_len)
     {
+        if (changed_len != nullptr)
+            *changed_len = 0;
         if (ie < 2)
         {
             std::fprintf(stderr, "i-excluding: i should not less than 2\r\n");
@@ -421,210 +875,379 @@ typedef unsigned char byte;
             return false;
         }
         bool isAnyUpdate = false;
-        /* scan candidate, from begin to the end */
-        const unsigned int sizegrid = Size();
-        unsigned int bitcounter;
-        const byte bitFilter = 0x01;
-        byte clueMask[mask_cell_len];
-        byte tmpByte;
-        unsigned int cluecounter;
-        unsigned int sIdx;
-        unsigned int eIdx;
-        bool tmpBool;
-        for (int i = 0; i < sizegrid; i++)
+        if (stats != nullptr && ie < SolveStats::MAX_IE)
+            stats->excluding_calls[ie]++;
+        /* candidates of a lattice packed into whole words */
+        const unsigned int wordLen = (length + 63) / 64;
+        std::uint64_t words[length * wordLen];
+        /* empty lattices of the unit, and those that may
+        belong to a subset */
+        unsigned int empties[length];
+        unsigned int members[length];
+        /* subset being enumerated: positions in members and
+        the union of candidates at each depth */
+        unsigned int chosen[length + 1];
+        std::uint64_t unions[(length + 1) * wordLen];
+        for (unsigned int unit = 0; unit < 3 * length; unit++)
         {
-            /* filt non-empty lattices */
-            if (lattices[i] != 0)
-                continue;
-            /* check if the mask is with no more than\\
-            ie positive bits */
-            bitcounter = 0;
-            for (int j = 0; j < mask_cell_len; j++)
-                for (int k = 0; k < len_byte; k++)
-                    bitcounter += ((mask[i * mask_cell_len + j] &
-                        (bitFilter << k)) != 0);
-            /* filt those mask that bitcount is larger than ie */
-            if (bitcounter > ie || bitcounter == 0)
+            /* pack masks of empty lattices */
+            unsigned int emptyLen = 0;
+            for (unsigned int k = 0; k < length; k++)
+            {
+                const unsigned int i = unitLattice(unit, k);
+                if (lattices[i] == 0)
+                    empties[emptyLen++] = i;
+            }
+            /* a subset has no more than half of the empty
+            lattices, the rest is a hidden subset */
+            const unsigned int limit = ie < emptyLen / 2 ? ie : emptyLen / 2;
+            if (limit < 2)
                 continue;
+            unsigned int memberLen = 0;
+            for (unsigned int k = 0; k < emptyLen; k++)
+            {
+                std::uint64_t* w = words + k * wordLen;
+                for (unsigned int j = 0; j < wordLen; j++)
+                    w[j] = 0;
+                for (unsigned int j = 0; j < mask_cell_len; j++)
+                    w[j / 8] |= (std::uint64_t)mask[empties[k] * mask_cell_len + j] <<
+                        (8 * (j % 8));
+                unsigned int bitcounter = 0;
+                for (unsigned int j = 0; j < wordLen; j++)
+                    bitcounter += bitCount(w[j]);
+                if (bitcounter >= 2 && bitcounter <= limit)
+                    members[memberLen++] = k;
+            }
 
-            for (int j = 0; j < mask_cell_len; j++)
-                clueMask[j] = mask[i * mask_cell_len + j];
-                
-            /* row scan */
-            sIdx= (i / length) * length;
-            eIdx = sIdx + length;
-            cluecounter = 0;
-            for (int j = sIdx; j < eIdx; j++)
+            /* enumerate unions of members, depth first */
+            bool isUnitUpdated = false;
+            unsigned int depth = 0;
+            chosen[0] = 0;
+            for (unsigned int j = 0; j < wordLen; j++)
+                unions[j] = 0;
+            while (true)
             {
-                /* excluding mask = 0 */
-                tmpByte = 0;
-                for (int k = 0; k < mask_cell_len; k++)
-                    tmpByte |= mask[j * mask_cell_len + k];
-                if (tmpByte == 0)
+                if (chosen[depth] >= memberLen)
+                {
+                    /* backtrack */
+                    if (depth == 0)
+                        break;
+                    depth--;
+                    chosen[depth]++;
                     continue;
-                tmpBool = true;
-                for (int k = 0; k < mask_cell_len && tmpBool; k++)
-                    if ((clueMask[k] | mask[j * mask_cell_len + k]) !=
-                        clueMask[k])
-                        tmpBool = false;
-                if (tmpBool)
-                    cluecounter++;
-                if (cluecounter >= ie)
+                }
+                const std::uint64_t* w = words + members[chosen[depth]] * wordLen;
+                std::uint64_t* u = unions + (depth + 1) * wordLen;
+                unsigned int bitcounter = 0;
+                for (unsigned int j = 0; j < wordLen; j++)
+                {
+                    u[j] = unions[depth * wordLen + j] | w[j];
+                    bitcounter += bitCount(u[j]);
+                }
+                if (bitcounter > limit)
+                {
+                    chosen[depth]++;
+                    continue;
+                }
+                if (bitcounter == depth + 1)
                 {
-                    /* scan the row and eliminate non-clues */
-                    for (int k = sIdx; k < eIdx; k++)
+                    /* naked subset, eliminate its union from the
+                    other empty lattices */
+                    unsigned int c = 0;
+                    for (unsigned int k = 0; k < emptyLen; k++)
                     {
-                        tmpByte = 0;
-                        for (int l = 0; l < mask_cell_len; l++)
-                            tmpByte |= mask[k * mask_cell_len + l];
-                        if (tmpByte == 0)
+                        if (c <= depth && members[chosen[c]] == k)
+                        {
+                            c++;
                             continue;
-
-                        tmpBool = true;
-                        for (int l = 0; l < mask_cell_len && tmpBool; l++)
-                            if ((clueMask[l] | mask[k * mask_cell_len + l]) !=
-                                clueMask[l])
-                                tmpBool = false;
-                        /* found non-clue*/
-                        if (!tmpBool)
-                        {   
-                            /* they must have intersection */
-                            tmpByte = 0;
-                            for (int l = 0; l < mask_cell_len; l++)
-                                tmpByte |= (clueMask[l] & mask[k * mask_cell_len + l]);
-                            if (tmpByte != 0)
+                        }
+                        std::uint64_t* o = words + k * wordLen;
+                        bool isChanged = false;
+                        for (unsigned int j = 0; j < wordLen; j++)
+                            if ((o[j] & u[j]) != 0)
                             {
-                                isAnyUpdate = true;
-                                for (int l = 0; l < mask_cell_len; l++)
-                                    mask[k * mask_cell_len + l] &=
-                                        (~clueMask[l]);
+                                if (stats != nullptr && ie < SolveStats::MAX_IE)
+                                    stats->excluding_eliminations[ie] +=
+                                        bitCount(o[j] & u[j]);
+                                o[j] &= ~u[j];
+                                isChanged = true;
                             }
+                        if (!isChanged)
+                            continue;
+                        for (unsigned int j = 0; j < mask_cell_len; j++)
+                        {
+                            const byte removed = (byte)(u[j / 8] >> (8 * (j % 8)));
+                            if ((mask[empties[k] * mask_cell_len + j] &
+                                removed) == 0)
+                                continue;
+                            trailMask(empties[k] * mask_cell_len + j);
+                            mask[empties[k] * mask_cell_len + j] &= ~removed;
                         }
+                        checkLattice(empties[k]);
+                        isUnitUpdated = true;
                     }
-                    break;
+                    chosen[depth]++;
+                    continue;
+                }
+                /* go deeper */
+                if (depth + 1 < limit)
+                {
+                    chosen[depth + 1] = chosen[depth] + 1;
+                    depth++;
                 }
+                else
+                    chosen[depth]++;
+            }
+            if (isUnitUpdated)
+            {
+                isAnyUpdate = true;
+                if (changed != nullptr && changed_len != nullptr)
+                    changed[(*changed_len)++] = unit;
             }
+        }
+        return isAnyUpdate;
+    }
+
+    unsigned int Grid::unitLattice(const unsigned int& unit,
+        const unsigned int& k)
+    {
+        if (unit < length)
+            return unit * length + k;
+        if (unit < 2 * length)
+            return k * length + unit - length;
+        const unsigned int block = unit - 2 * length;
+        return ((block / blocklength) * blocklength + k / blocklength) * length +
+            (block % blocklength) * blocklength + k % blocklength;
+    }
 
-            /* column scan */
-            sIdx = i % length;
-            eIdx = sizegrid - (length - (i % length)) + 1;
-            cluecounter = 0;
-            for (int j = sIdx; j < eIdx; j += length)
+    bool Grid::hiding(const unsigned int& ie)
+    {
+        bool isAnyUpdate = false;
+        unsigned long* eliminations = nullptr;
+        if (stats != nullptr && ie < SolveStats::MAX_IE)
+        {
+            stats->hiding_calls[ie]++;
+            eliminations = stats->hiding_eliminations + ie;
+        }
+        /* where[d]: positions inside the unit where digit d + 1
+        can go, packed into whole words */
+        const unsigned int wordLen = (length + 63) / 64;
+        std::uint64_t where[length * wordLen];
+        /* digits that may belong to a subset, the subset being
+        enumerated and the union of positions at each depth */
+        unsigned int members[length];
+        unsigned int chosen[length + 1];
+        std::uint64_t unions[(length + 1) * wordLen];
+        byte placed[mask_cell_len];
+        byte digitMask[mask_cell_len];
+        unsigned int bitcounter;
+        for (unsigned int unit = 0; unit < 3 * length; unit++)
+        {
+            if (ie == 1)
             {
-                /* excluding mask = 0 */
-                tmpByte = 0;
-                for (int k = 0; k < mask_cell_len; k++)
-                    tmpByte |= mask[j * mask_cell_len + k];
-                if (tmpByte == 0)
-                    continue;
-                    
-                tmpBool = true;
-                for (int k = 0; k < mask_cell_len && tmpBool; k++)
-                    if ((clueMask[k] | mask[j * mask_cell_len + k]) !=
-                        clueMask[k])
-                        tmpBool = false;
-                if (tmpBool)
-                    cluecounter++;
-                    
-                if (cluecounter >= ie)
+                /* hidden singles: digits seen exactly once,
+                without building the index */
+                byte* once = placed;
+                byte* twice = digitMask;
+                for (unsigned int j = 0; j < mask_cell_len; j++)
+                {
+                    once[j] = 0;
+                    twice[j] = 0;
+                }
+                for (unsigned int k = 0; k < length; k++)
                 {
-                    /* scan the column and eliminate non-clues */
-                    for (int k = sIdx; k < eIdx; k += length)
+                    const byte* m = mask + unitLattice(unit, k) * mask_cell_len;
+                    for (unsigned int j = 0; j < mask_cell_len; j++)
                     {
-                        tmpByte = 0;
-                        for (int l = 0; l < mask_cell_len; l++)
-                            tmpByte |= mask[k * mask_cell_len + l];
-                        if (tmpByte == 0)
-                            continue;
-
-                        tmpBool = true;
-                        for (int l = 0; l < mask_cell_len && tmpBool; l++)
-                            if ((clueMask[l] | mask[k * mask_cell_len + l]) !=
-                                clueMask[l])
-                                tmpBool = false;
-                            
-                        /* found non-clue*/
-                        if (!tmpBool)
-                        {   
-                            /* they must have intersection */
-                            tmpByte = 0;
-                            for (int l = 0; l < mask_cell_len; l++)
-                                tmpByte |= (clueMask[l] & mask[k * mask_cell_len + l]);
-                            if (tmpByte != 0)
+                        twice[j] |= once[j] & m[j];
+                        once[j] |= m[j];
+                    }
+                }
+                for (unsigned int j = 0; j < mask_cell_len; j++)
+                    for (byte single = once[j] & ~twice[j]; single != 0;
+                        single &= single - 1)
+                    {
+                        const byte bit = single & (~single + 1);
+                        for (unsigned int k = 0; k < length; k++)
+                        {
+                            const unsigned int i = unitLattice(unit, k);
+                            if ((mask[i * mask_cell_len + j] & bit) == 0)
+                                continue;
+                            bool isChanged = false;
+                            for (unsigned int l = 0; l < mask_cell_len; l++)
+                            {
+                                const byte tmpMask = l == j ? bit : 0;
+                                if (mask[i * mask_cell_len + l] != tmpMask)
+                                {
+                                    if (eliminations != nullptr)
+                                        *eliminations += bitCount((std::uint32_t)
+                                            (mask[i * mask_cell_len + l] & ~tmpMask));
+                                    trailMask(i * mask_cell_len + l);
+                                    mask[i * mask_cell_len + l] = tmpMask;
+                                    isChanged = true;
+                                }
+                            }
+                            if (isChanged)
                             {
                                 isAnyUpdate = true;
-                                for (int l = 0; l < mask_cell_len; l++)
-                                    mask[k * mask_cell_len + l] &=
-                                        (~clueMask[l]);
+                                checkLattice(i);
                             }
+                            break;
                         }
                     }
-                    break;
+                continue;
+            }
+
+            /* build the index of the unit */
+            for (unsigned int j = 0; j < length * wordLen; j++)
+                where[j] = 0;
+            for (unsigned int j = 0; j < mask_cell_len; j++)
+                placed[j] = 0;
+            for (unsigned int k = 0; k < length; k++)
+            {
+                const unsigned int i = unitLattice(unit, k);
+                if (lattices[i] != 0)
+                {
+                    placed[(lattices[i] - 1) / len_byte] |=
+                        0x01 << ((lattices[i] - 1) % len_byte);
+                    continue;
                 }
+                for (unsigned int j = 0; j < mask_cell_len; j++)
+                    for (byte tmpMask = mask[i * mask_cell_len + j]; tmpMask != 0;
+                        tmpMask &= tmpMask - 1)
+                    {
+                        const unsigned int d = j * len_byte +
+                            lowBit((std::uint32_t)tmpMask);
+                        where[d * wordLen + k / 64] |= (std::uint64_t)1 << (k % 64);
+                    }
             }
 
-            /* block scan */
-            unsigned int block_y = (i / length) / blocklength + 1;
-            unsigned int block_x = (i % length) / blocklength + 1;
-            cluecounter = 0;
-            for (int y = (block_y - 1) * blocklength;
-                y < block_y * blocklength; y++)
-                for (int x = (block_x - 1) * blocklength;
-                    x < block_x * blocklength; x++)
+            unsigned int freeLen = 0;
+            unsigned int memberLen = 0;
+            for (unsigned int d = 0; d < length; d++)
+            {
+                if (placed[d / len_byte] & (0x01 << (d % len_byte)))
+                    continue;
+                freeLen++;
+                const std::uint64_t* clue = where + d * wordLen;
+                bitcounter = 0;
+                for (unsigned int j = 0; j < wordLen; j++)
+                    bitcounter += bitCount(clue[j]);
+                /* a digit with nowhere to go */
+                if (bitcounter == 0)
+                {
+                    isDead = true;
+                    return isAnyUpdate;
+                }
+                if (bitcounter >= 2)
+                {
+                    if (bitcounter <= ie)
+                        members[memberLen++] = d;
+                    continue;
+                }
+                /* hidden single, no need to look for partners */
+                unsigned int k = 0;
+                while (clue[k] == 0)
+                    k++;
+                const unsigned int i = unitLattice(unit, k * 64 + lowBit(clue[k]));
+                for (unsigned int j = 0; j < mask_cell_len; j++)
+                    digitMask[j] = 0;
+                digitMask[d / len_byte] = 0x01 << (d % len_byte);
+                bool isChanged = false;
+                for (unsigned int j = 0; j < mask_cell_len; j++)
+                    if (mask[i * mask_cell_len + j] != digitMask[j])
+                    {
+                        if (eliminations != nullptr)
+                            *eliminations += bitCount((std::uint32_t)
+                                (mask[i * mask_cell_len + j] & ~digitMask[j]));
+                        trailMask(i * mask_cell_len + j);
+                        mask[i * mask_cell_len + j] = digitMask[j];
+                        isChanged = true;
+                    }
+                if (isChanged)
                 {
-                    /* excluding mask = 0 */
-                    tmpByte = 0;
-                    for (int k = 0; k < mask_cell_len; k++)
-                        tmpByte |= mask[y * length * mask_cell_len +
-                            x * mask_cell_len + k];
-                    if (tmpByte == 0)
-                        continue;
-
-                    tmpBool = true;
-                    for (int k = 0; k < mask_cell_len && tmpBool; k++)
-                        if ((clueMask[k] | mask[y * length * mask_cell_len +
-                            x * mask_cell_len + k]) != clueMask[k])
-                            tmpBool = false;
-                    if (tmpBool)
-                        cluecounter++;
+                    isAnyUpdate = true;
+                    checkLattice(i);
                 }
-            if (cluecounter >= ie)
+            }
+            /* a hidden subset has no more than half of the free
+            digits, the rest is a naked subset */
+            const unsigned int limit = ie < freeLen / 2 ? ie : freeLen / 2;
+            if (limit < 2)
+                continue;
+
+            /* enumerate unions of the positions of members, depth
+            first: k digits whose positions add up to k lattices
+            are a hidden subset */
+            unsigned int depth = 0;
+            chosen[0] = 0;
+            for (unsigned int j = 0; j < wordLen; j++)
+                unions[j] = 0;
+            while (true)
             {
-                /* scan the block and eliminate non-clues */
-                for (int y = (block_y - 1) * blocklength;
-                    y < block_y * blocklength; y++)
-                    for (int x = (block_x - 1) * blocklength;
-                        x < block_x * blocklength; x++)
+                if (chosen[depth] >= memberLen)
+                {
+                    /* backtrack */
+                    if (depth == 0)
+                        break;
+                    depth--;
+                    chosen[depth]++;
+                    continue;
+                }
+                const std::uint64_t* w = where + members[chosen[depth]] * wordLen;
+                std::uint64_t* u = unions + (depth + 1) * wordLen;
+                bitcounter = 0;
+                for (unsigned int j = 0; j < wordLen; j++)
+                {
+                    u[j] = unions[depth * wordLen + j] | w[j];
+                    bitcounter += bitCount(u[j]);
+                }
+                if (bitcounter > limit)
+                {
+                    chosen[depth]++;
+                    continue;
+                }
+                if (bitcounter == depth + 1)
+                {
+                    /* those positions hold nothing but those digits */
+                    for (unsigned int j = 0; j < mask_cell_len; j++)
+                        digitMask[j] = 0;
+                    for (unsigned int c = 0; c <= depth; c++)
+                        digitMask[members[chosen[c]] / len_byte] |=
+                            0x01 << (members[chosen[c]] % len_byte);
+                    for (unsigned int k = 0; k < length; k++)
                     {
-                        tmpByte = 0;
-                        for (int l = 0; l < mask_cell_len; l++)
-                            tmpByte |= mask[y * length * mask_cell_len +
-                                x * mask_cell_len + l];
-                        if (tmpByte == 0)
+                        if ((u[k / 64] & ((std::uint64_t)1 << (k % 64))) == 0)
                             continue;
-
-                        tmpBool = true;
-                        for (int l = 0; l < mask_cell_len && tmpBool; l++)
-                            if ((clueMask[l] | mask[y * length * mask_cell_len +
-                                x * mask_cell_len + l]) != clueMask[l])
-                                tmpBool = false;
-                        /* found non-clue*/
-                        if (!tmpBool)
-                        {   
-                            /* they must have intersection */
-                            tmpByte = 0;
-                            for (int l = 0; l < mask_cell_len; l++)
-                                tmpByte |= (clueMask[l] & mask[y * length * mask_cell_len +
-                                x * mask_cell_len + l]);
-                            if (tmpByte != 0)
+                        const unsigned int i = unitLattice(unit, k);
+                        bool isChanged = false;
+                        for (unsigned int j = 0; j < mask_cell_len; j++)
+                            if ((mask[i * mask_cell_len + j] & ~digitMask[j]) != 0)
                             {
-                                isAnyUpdate = true;
-                                for (int l = 0; l < mask_cell_len; l++)
-                                    mask[y * length * mask_cell_len +
-                                        x * mask_cell_len + l] &= (~clueMask[l]);
+                                if (eliminations != nullptr)
+                                    *eliminations += bitCount((std::uint32_t)
+                                        (mask[i * mask_cell_len + j] & ~digitMask[j]));
+                                trailMask(i * mask_cell_len + j);
+                                mask[i * mask_cell_len + j] &= digitMask[j];
+                                isChanged = true;
                             }
+                        if (isChanged)
+                        {
+                            isAnyUpdate = true;
+                            checkLattice(i);
                         }
                     }
+                    chosen[depth]++;
+                    continue;
+                }
+                /* go deeper */
+                if (depth + 1 < limit)
+                {
+                    chosen[depth + 1] = chosen[depth] + 1;
+                    depth++;
+                }
+                else
+                    chosen[depth]++;
             }
         }
         return isAnyUpdate;
@@ -632,40 +1255,166 @@ typedef unsigned char byte;
 
     void Grid::dispGrid()
     {
-        for (int i = 0; i < length; i++)
+        /* format the whole grid, then write it at once */
+        std::string out;
+        out.reserve(Size() * 4 + length * 2);
+        char tmpStr[4];
+        for (unsigned int i = 0; i < Size(); i++)
         {
-            for (int j = 0; j < length; j++)
+            int value = lattices[i];
+            char* p = tmpStr + sizeof(tmpStr);
+            do
             {
-                if (j == length - 1)
-                {
-                    std::printf("%d", lattices[i * length + j]);
-                    continue;
-                }
-                std::printf("%d,", lattices[i * length + j]);
-            }
-            std::printf("\r\n");
+                *--p = (char)('0' + value % 10);
+                value /= 10;
+            } while (value != 0);
+            out.append(p, tmpStr + sizeof(tmpStr) - p);
+            out += (i % length == length - 1) ? "\r\n" : ",";
         }
+        std::fwrite(out.data(), 1, out.size(), stdout);
     }
 
-    Grid::Grid(const unsigned int& length,
+    void Grid::resize(const unsigned int& length,
         const unsigned int& blocklength)
-        :length(length), blocklength(blocklength)
     {
-        /* allocate memory for lattices */
-        lattices = (char*)std::malloc(
-            Size() * sizeof(char));
-        /* set zero */
-        for (int i = 0; i < Size(); i++)
-            lattices[i] = 0;
-
-        /* allocate memory for mask */
+        this->length = length;
+        this->blocklength = blocklength;
         mask_cell_len = my_ceil(length, len_byte);
         mask_len = Size() * mask_cell_len;
-        mask = (byte*)std::malloc(mask_len *
-            sizeof(byte));
+        /* grow memory only */
+        if (Size() > lat_capacity)
+        {
+            lattices = (char*)std::realloc(lattices,
+                Size() * sizeof(char));
+            lat_capacity = Size();
+        }
+        if (mask_len > mask_capacity)
+        {
+            mask = (byte*)std::realloc(mask, mask_len *
+                sizeof(byte));
+            mask_capacity = mask_len;
+        }
+        if (Size() > singles_capacity)
+        {
+            singles = (unsigned int*)std::realloc(singles,
+                Size() * sizeof(unsigned int));
+            /* the trail records slots before they are written */
+            std::memset(singles, 0, Size() * sizeof(unsigned int));
+            singles_capacity = Size();
+        }
+        if (4 * length * mask_cell_len > unit_mask_capacity)
+        {
+            unit_mask = (byte*)std::realloc(unit_mask,
+                4 * length * mask_cell_len * sizeof(byte));
+            unit_mask_capacity = 4 * length * mask_cell_len;
+        }
+        buildPeers();
+        /* set zero */
+        std::memset(lattices, 0, Size() * sizeof(char));
         /* set true */
-        for (int i = 0; i < mask_len; i++)
-            mask[i] = 0xFF;
+        std::memset(mask, 0xFF, mask_len * sizeof(byte));
+        singles_len = 0;
+        isDead = false;
+        /* open marks do not survive a new puzzle */
+        trail_len = trail_depth = 0;
+    }
+
+    void Grid::load(const char* digits)
+    {
+        std::memcpy(lattices, digits, Size() * sizeof(char));
+        std::memset(mask, 0xFF, mask_len * sizeof(byte));
+        singles_len = 0;
+        isDead = false;
+        /* open marks do not survive a new puzzle */
+        trail_len = trail_depth = 0;
+    }
+
+    Grid::Grid(const unsigned int& length,
+        const unsigned int& blocklength)
+        :lattices(nullptr), mask(nullptr), length(length),
+        blocklength(blocklength), lat_capacity(0), mask_capacity(0),
+        peers(nullptr), peer_capacity(0), peer_length(0),
+        singles(nullptr), singles_capacity(0), unit_mask(nullptr),
+        unit_mask_capacity(0), trail(nullptr), trail_len(0),
+        trail_capacity(0), trail_depth(0)
+    {
+        /* allocate memory and set lattices zero, mask true */
+        resize(length, blocklength);
+    }
+
+    void Grid::copyFrom(const Grid& other)
+    {
+        resize(other.length, other.blocklength);
+        std::memcpy(lattices, other.lattices, Size() * sizeof(char));
+        std::memcpy(mask, other.mask, mask_len * sizeof(byte));
+        std::memcpy(singles, other.singles,
+            other.singles_len * sizeof(unsigned int));
+        singles_len = other.singles_len;
+        isDead = other.isDead;
+        isVerbose = other.isVerbose;
+        stats = other.stats;
+    }
+
+    void Grid::swap(Grid& other)
+    {
+        std::swap(lattices, other.lattices);
+        std::swap(mask, other.mask);
+        std::swap(mask_len, other.mask_len);
+        std::swap(mask_cell_len, other.mask_cell_len);
+        std::swap(length, other.length);
+        std::swap(blocklength, other.blocklength);
+        std::swap(lat_capacity, other.lat_capacity);
+        std::swap(mask_capacity, other.mask_capacity);
+        std::swap(isVerbose, other.isVerbose);
+        std::swap(stats, other.stats);
+        std::swap(peers, other.peers);
+        std::swap(peer_len, other.peer_len);
+        std::swap(peer_capacity, other.peer_capacity);
+        std::swap(peer_length, other.peer_length);
+        std::swap(singles, other.singles);
+        std::swap(singles_len, other.singles_len);
+        std::swap(singles_capacity, other.singles_capacity);
+        std::swap(isDead, other.isDead);
+        std::swap(unit_mask, other.unit_mask);
+        std::swap(unit_mask_capacity, other.unit_mask_capacity);
+        std::swap(trail, other.trail);
+        std::swap(trail_len, other.trail_len);
+        std::swap(trail_capacity, other.trail_capacity);
+        std::swap(trail_depth, other.trail_depth);
+    }
+
+    Grid::Grid(const Grid& other)
+        :lattices(nullptr), mask(nullptr), length(0), blocklength(0),
+        lat_capacity(0), mask_capacity(0), peers(nullptr),
+        peer_capacity(0), peer_length(0), singles(nullptr),
+        singles_capacity(0), unit_mask(nullptr), unit_mask_capacity(0),
+        trail(nullptr), trail_len(0), trail_capacity(0), trail_depth(0)
+    {
+        copyFrom(other);
+    }
+
+    Grid::Grid(Grid&& other) noexcept
+        :lattices(nullptr), mask(nullptr), mask_len(0), mask_cell_len(0),
+        length(0), blocklength(0), lat_capacity(0), mask_capacity(0),
+        peers(nullptr), peer_len(0), peer_capacity(0), peer_length(0),
+        singles(nullptr), singles_len(0), singles_capacity(0),
+        isDead(false), unit_mask(nullptr), unit_mask_capacity(0),
+        trail(nullptr), trail_len(0), trail_capacity(0), trail_depth(0)
+    {
+        swap(other);
+    }
+
+    Grid& Grid::operator=(const Grid& other)
+    {
+        if (this != &other)
+            copyFrom(other);
+        return *this;
+    }
+
+    Grid& Grid::operator=(Grid&& other) noexcept
+    {
+        swap(other);
+        return *this;
     }
 
     Grid::~Grid()
@@ -673,5 +1422,9 @@ typedef unsigned char byte;
         /* free memory */
         std::free(lattices);
         std::free(mask);
+        std::free(peers);
+        std::free(singles);
+        std::free(unit_mask);
+        std::free(trail);
     }
 }
\ No newline at end of file
@@ -0,0 +1,318 @@
+/*******************************************
+ * @title   Generator
+ * @brief   generate puzzles with a unique
+ * solution from random complete grids
+ * @author  Bin Qu
+ * @date    2026.10.17
+ * @copyright   You can edit and remodify
+ * this file.
+*******************************************/
+
+#include "batch.h"
+#include "FixedGrid.h"
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace sds
+{
+    /**
+     * Difficulty of a puzzle, by the rules it takes
+    */
+    enum Difficulty
+    {
+        /* no constraint */
+        diff_any,
+        /* naked and hidden singles */
+        diff_easy,
+        /* naked and hidden subsets of any size */
+        diff_medium,
+        /* a guess is needed */
+        diff_hard
+    };
+
+    /**
+     * What to generate
+    */
+    struct GenerateOptions
+    {
+        /* grid size length, 4, 9, 16 or 25 */
+        unsigned int length;
+        /* stop removing clues at this many, 0 for as few
+        as possible */
+        unsigned int clues;
+        Difficulty difficulty;
+        /* puzzle k is generated from (seed, k) alone, so the
+        output does not depend on the number of threads */
+        std::uint64_t seed;
+    };
+
+    /**
+     * @brief parse a difficulty name
+     * @param name "any", "easy", "medium" or "hard"
+     * @param difficulty receives the difficulty
+     * @return false if the name is unknown
+    */
+    static bool parseDifficulty(const char* name, Difficulty& difficulty);
+
+    /**
+     * @brief generate a puzzle with a unique solution
+     * @param options what to generate, length is N
+     * @param rng random source
+     * @param puzzle output row-major digits, 0 for empty
+     * @return false if no attempt met the clue count and
+     * difficulty, puzzle then holds the closest one
+    */
+    template <unsigned int N, typename Word>
+    static bool generateFixed(const GenerateOptions& options,
+        std::mt19937_64& rng, std::vector<char>& puzzle);
+
+    /**
+     * @brief generate a puzzle with the FixedGrid that fits
+     * options.length
+     * @return false if no attempt met the clue count and
+     * difficulty, or the size is not supported
+    */
+    static bool generatePuzzle(const GenerateOptions& options,
+        std::mt19937_64& rng, std::vector<char>& puzzle);
+
+    /**
+     * @brief generate puzzles and write them to stdout as csv
+     * grids separated by blank lines, in seed order
+     * @param count the number of puzzles
+     * @param options what to generate
+     * @param threads the number of generating threads, 0 for
+     * one per hardware thread
+     * @return 0 if every puzzle met the clue count and difficulty
+    */
+    static int runGenerate(unsigned long count,
+        const GenerateOptions& options, unsigned int threads);
+
+    static bool parseDifficulty(const char* name, Difficulty& difficulty)
+    {
+        static const char* names[] = {"any", "easy", "medium", "hard"};
+        for (int i = diff_any; i <= diff_hard; i++)
+            if (std::strcmp(name, names[i]) == 0)
+            {
+                difficulty = (Difficulty)i;
+                return true;
+            }
+        return false;
+    }
+
+    template <unsigned int N, typename Word>
+    static bool generateFixed(const GenerateOptions& options,
+        std::mt19937_64& rng, std::vector<char>& puzzle)
+    {
+        constexpr unsigned int B = FixedGrid<N, Word>::B;
+        constexpr unsigned int S = N * N;
+        /* kept per thread and reused */
+        static thread_local std::vector<FixedGrid<N, Word>> fixed(1);
+        FixedGrid<N, Word>& grid = fixed[0];
+        /* the clues left so far, loaded but not propagated,
+        and the same without the clue being tried */
+        static thread_local std::vector<typename FixedGrid<N, Word>::State> states(2);
+        typename FixedGrid<N, Word>::State* parent = &states[0];
+        typename FixedGrid<N, Word>::State* child = &states[1];
+        std::vector<char> solution(S);
+        std::vector<char> best;
+        std::vector<unsigned int> order(S);
+        unsigned int perm[N];
+        const unsigned int attempts = 64;
+        for (unsigned int attempt = 0; attempt < attempts; attempt++)
+        {
+            /* blocks of the diagonal share no unit, fill them
+            freely and let the search complete the rest */
+            puzzle.assign(S, 0);
+            for (unsigned int b = 0; b < B; b++)
+            {
+                for (unsigned int k = 0; k < N; k++)
+                    perm[k] = k + 1;
+                std::shuffle(perm, perm + N, rng);
+                for (unsigned int k = 0; k < N; k++)
+                    puzzle[(b * B + k / B) * N + b * B + k % B] = perm[k];
+            }
+            if (!grid.load(puzzle.data()) || !grid.solve())
+                continue;
+            /* shuffle rows inside bands and the bands, the
+            search always fills the rest the same way */
+            unsigned int rows[N];
+            unsigned int bands[B];
+            for (unsigned int k = 0; k < B; k++)
+                bands[k] = k;
+            std::shuffle(bands, bands + B, rng);
+            for (unsigned int b = 0; b < B; b++)
+            {
+                unsigned int inside[B];
+                for (unsigned int k = 0; k < B; k++)
+                    inside[k] = k;
+                std::shuffle(inside, inside + B, rng);
+                for (unsigned int k = 0; k < B; k++)
+                    rows[b * B + k] = bands[b] * B + inside[k];
+            }
+            for (unsigned int i = 0; i < S; i++)
+                solution[i] = grid.Lattices()[rows[i / N] * N + i % N];
+
+            /* remove clues in random order while the solution
+            stays unique and the rules stay within reach */
+            puzzle.assign(solution.begin(), solution.end());
+            unsigned int clues = S;
+            for (unsigned int i = 0; i < S; i++)
+                order[i] = i;
+            std::shuffle(order.begin(), order.end(), rng);
+            const unsigned int max_ie = options.difficulty == diff_easy ? 1 : N;
+            /* a proof that takes longer keeps the clue, which
+            costs a clue now and then but bounds big grids */
+            const unsigned long max_nodes = 2 * N;
+            /* singles keep the nodes of small proofs cheap */
+            const unsigned int search_ie = N <= 9 ? 1 : 2;
+            grid.load(puzzle.data());
+            grid.saveState(*parent);
+            for (unsigned int k = 0; k < S && clues > options.clues; k++)
+            {
+                const unsigned int i = order[k];
+                const char digit = puzzle[i];
+                /* take the clue off the parent instead of
+                loading the whole puzzle again */
+                grid.loadState(*parent);
+                grid.remove(i);
+                bool isKept = grid.isForced(i, digit);
+                /* a single among the clues needs no proof: the
+                rules place it back and the parent stood */
+                if (!isKept)
+                {
+                    grid.saveState(*child);
+                    /* what the rules complete has a unique solution */
+                    if (options.difficulty == diff_easy ||
+                        options.difficulty == diff_medium)
+                        isKept = grid.deduce(max_ie);
+                    else
+                    {
+                        /* unique if no solution has another digit there */
+                        grid.exclude(i, digit);
+                        isKept = !grid.hasSolution(max_nodes, search_ie);
+                    }
+                    grid.loadState(*child);
+                }
+                if (isKept)
+                {
+                    puzzle[i] = 0;
+                    clues--;
+                    grid.saveState(*parent);
+                }
+            }
+
+            /* rate what is left */
+            bool isMet = clues <= options.clues || options.clues == 0;
+            if (isMet && options.difficulty != diff_any)
+            {
+                grid.load(puzzle.data());
+                const bool isEasy = grid.deduce(1);
+                grid.load(puzzle.data());
+                const bool isLogic = isEasy || grid.deduce(N);
+                const Difficulty rated = isEasy ? diff_easy :
+                    isLogic ? diff_medium : diff_hard;
+                isMet = rated == options.difficulty;
+            }
+            if (isMet)
+                return true;
+            if (best.empty() || std::count(puzzle.begin(), puzzle.end(), 0) >
+                std::count(best.begin(), best.end(), 0))
+                best = puzzle;
+        }
+        if (!best.empty())
+            puzzle = best;
+        return false;
+    }
+
+    static bool generatePuzzle(const GenerateOptions& options,
+        std::mt19937_64& rng, std::vector<char>& puzzle)
+    {
+        switch (options.length)
+        {
+        case 4:
+            return generateFixed<4, std::uint16_t>(options, rng, puzzle);
+        case 9:
+            return generateFixed<9, std::uint16_t>(options, rng, puzzle);
+        case 16:
+            return generateFixed<16, std::uint16_t>(options, rng, puzzle);
+        case 25:
+            return generateFixed<25, std::uint32_t>(options, rng, puzzle);
+        default:
+            puzzle.clear();
+            return false;
+        }
+    }
+
+    static int runGenerate(unsigned long count,
+        const GenerateOptions& options, unsigned int threads)
+    {
+        std::unique_ptr<ThreadPool> pool;
+        if (threads != 1)
+            pool.reset(new ThreadPool(threads));
+        const unsigned int workers = pool ? pool->Size() : 1;
+
+        /* puzzles of a window, and whether each met the options */
+        std::vector<std::vector<char>> puzzles(256 * workers);
+        std::vector<char> isMet(puzzles.size());
+        std::string out;
+        unsigned long missed = 0;
+        auto startTime = std::chrono::steady_clock::now();
+        for (unsigned long first = 0; first < count; first += puzzles.size())
+        {
+            const unsigned int window = (unsigned int)std::min<unsigned long>(
+                puzzles.size(), count - first);
+            auto generate = [&](unsigned int k)
+            {
+                std::seed_seq seq{(std::uint32_t)options.seed,
+                    (std::uint32_t)(options.seed >> 32),
+                    (std::uint32_t)(first + k),
+                    (std::uint32_t)((first + k) >> 32)};
+                std::mt19937_64 rng(seq);
+                isMet[k] = generatePuzzle(options, rng, puzzles[k]);
+            };
+            if (pool)
+            {
+                for (unsigned int k = 0; k < window; k++)
+                    pool->submit([&generate, k](unsigned int)
+                        { generate(k); });
+                pool->wait();
+            }
+            else
+                for (unsigned int k = 0; k < window; k++)
+                    generate(k);
+
+            /* write in seed order, in big chunks */
+            for (unsigned int k = 0; k < window; k++)
+            {
+                missed += !isMet[k];
+                formatPuzzle(puzzles[k].data(), options.length,
+                    PuzzleFormat::fmt_csv, out);
+                if (out.size() >= (1 << 16))
+                {
+                    std::fwrite(out.data(), 1, out.size(), stdout);
+                    out.clear();
+                }
+            }
+        }
+        std::fwrite(out.data(), 1, out.size(), stdout);
+        std::fflush(stdout);
+
+        double seconds = std::chrono::duration<double>(
+            std::chrono::steady_clock::now() - startTime).count();
+        std::fprintf(stderr,
+            "generate: %lu puzzles, %lu missed the clue count or difficulty, "
+            "seed %llu, in %.3f s (%.1f puzzles/sec, %u threads)\r\n",
+            count, missed, (unsigned long long)options.seed, seconds,
+            seconds > 0 ? count / seconds : 0.0, workers);
+        return missed == 0 ? 0 : -1;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,4 @@
+#ifndef GENERATOR_H
+#define GENERATOR_H
+#include "generator.cxx"
+#endif
\ No newline at end of file
@@ -0,0 +1,152 @@
+/*******************************************
+ * @title   Library
+ * @brief   reusable solver context behind
+ * the C interface of libsudoku
+ * @author  Bin Qu
+ * @date    2026.10.17
+ * @copyright   You can edit and remodify
+ * this file.
+*******************************************/
+
+#include "batch.h"
+#include "CSVreader.h"
+#include "PuzzleReader.h"
+#include "sudoku.h"
+
+#include <cstring>
+#include <string>
+
+namespace sds
+{
+    /**
+     * A solver to keep and call over and over. Every buffer
+     * is owned by the context and grows to the largest puzzle
+     * seen, so once a size has been solved, solving another
+     * puzzle of that size allocates nothing. A context is not
+     * shared: give each thread its own.
+    */
+    class SolverContext
+    {
+    private:
+        /**
+         * @brief grid, searcher and dancing links buffers
+        */
+        SolveContext context;
+        /**
+         * @brief the puzzle being solved
+        */
+        BatchJob job;
+        /**
+         * @brief the solution formatted as text
+        */
+        std::string text;
+        /**
+         * @brief use dancing links instead of the logic engine
+        */
+        bool isDLX = false;
+
+        /**
+         * @brief solve job, whose digits and length are set
+         * @return SDS_SOLVED, SDS_UNSOLVABLE or SDS_INVALID
+        */
+        int solveJob();
+
+    public:
+        /**
+         * @brief choose dancing links or the logic engine
+        */
+        void setDLX(bool isDLX) { this->isDLX = isDLX; }
+        /**
+         * @brief look solutions up in a cache shared with other
+         * contexts, and add new ones to it, nullptr for none
+        */
+        void setCache(SolutionCache* cache) { context.cache = cache; }
+        /**
+         * @brief look solutions up in a store file, and add new
+         * ones to it, nullptr for none
+        */
+        void setStore(SolutionStore* store) { context.store = store; }
+        /**
+         * @brief solve a puzzle text, see sds_solve()
+         * @param in puzzle text
+         * @param in_len the number of bytes of in
+         * @param out output buffer
+         * @param out_size size of out in bytes
+         * @return one of sds_status
+        */
+        int solve(const char* in, std::size_t in_len, char* out,
+            std::size_t out_size);
+        /**
+         * @brief solve a puzzle text into Text()
+         * @param in puzzle text
+         * @param in_len the number of bytes of in
+         * @return SDS_SOLVED, SDS_UNSOLVABLE or SDS_INVALID
+        */
+        int solveText(const char* in, std::size_t in_len);
+        /**
+         * @brief the solution of the last solveText(), in the
+         * layout of its puzzle, without a line ending
+        */
+        const std::string& Text() const { return text; }
+        /**
+         * @brief solve a NUL-terminated puzzle text
+        */
+        int solve(const char* in, char* out, std::size_t out_size)
+        { return solve(in, std::strlen(in), out, out_size); }
+        /**
+         * @brief solve row-major digits, see sds_solve_digits()
+        */
+        int solveDigits(const char* in, char* out, unsigned int length);
+    };
+
+    int SolverContext::solveJob()
+    {
+        const unsigned int sizegrid = job.length * job.length;
+        for (unsigned int i = 0; i < sizegrid; i++)
+            if (job.digits[i] < 0 || (unsigned int)job.digits[i] > job.length)
+                return SDS_INVALID;
+        sds::solveJob(job, context, isDLX);
+        return job.isSolved ? SDS_SOLVED : SDS_UNSOLVABLE;
+    }
+
+    int SolverContext::solveText(const char* in, std::size_t in_len)
+    {
+        text.clear();
+        if (!parsePuzzleText(in, in_len, job.digits, job.format, false) ||
+            !isGridSize(job.digits.size(), job.length))
+            return SDS_INVALID;
+        const int status = solveJob();
+        if (status != SDS_SOLVED)
+            return status;
+        formatPuzzle(job.digits.data(), job.length, job.format, text);
+        while (!text.empty() && (text.back() == '\n' || text.back() == '\r'))
+            text.pop_back();
+        return SDS_SOLVED;
+    }
+
+    int SolverContext::solve(const char* in, std::size_t in_len, char* out,
+        std::size_t out_size)
+    {
+        const int status = solveText(in, in_len);
+        if (status != SDS_SOLVED)
+            return status;
+        if (text.size() + 1 > out_size)
+            return SDS_BUFFER_TOO_SMALL;
+        std::memcpy(out, text.c_str(), text.size() + 1);
+        return SDS_SOLVED;
+    }
+
+    int SolverContext::solveDigits(const char* in, char* out,
+        unsigned int length)
+    {
+        unsigned int checked;
+        if (!isGridSize(length * length, checked))
+            return SDS_INVALID;
+        job.length = length;
+        job.digits.assign(in, in + length * length);
+        const int status = solveJob();
+        if (status == SDS_SOLVED)
+            std::memcpy(out, job.digits.data(), length * length);
+        return status;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,4 @@
+#ifndef LIBRARY_H
+#define LIBRARY_H
+#include "library.cxx"
+#endif
\ No newline at end of file
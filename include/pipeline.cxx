@@ -0,0 +1,450 @@
+/*******************************************
+ * @title   Pipeline
+ * @brief   read, solve and write a batch at
+ * once, over bounded lock-free rings
+ * @author  Bin Qu
+ * @date    2026.10.17
+ * @copyright   You can edit and remodify
+ * this file.
+*******************************************/
+
+#include "batch.h"
+#include "PuzzleReader.h"
+#include "stats.h"
+#include "trace.h"
+#include "writer.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace sds
+{
+    /**
+     * Bounded multi-producer multi-consumer ring. Every cell
+     * carries a sequence that tells whose turn it is, so a
+     * push or a pop is one CAS on its own cursor and never
+     * blocks: a full or empty ring just returns false.
+    */
+    template <typename T>
+    class MpmcRing
+    {
+    private:
+        struct Cell
+        {
+            /* == position when free for a push at it,
+            position + 1 once pushed */
+            std::atomic<unsigned long> sequence;
+            T value;
+        };
+        std::unique_ptr<Cell[]> cells;
+        unsigned long mask;
+        /* on lines of their own, producers and consumers
+        do not share them */
+        alignas(64) std::atomic<unsigned long> head;
+        alignas(64) std::atomic<unsigned long> tail;
+
+    public:
+        /**
+         * @return false if the ring is full
+        */
+        bool push(const T& value);
+        /**
+         * @return false if the ring is empty
+        */
+        bool pop(T& value);
+        /**
+         * @brief constructor
+         * @param capacity at least this many values, rounded
+         * up to a power of 2
+        */
+        MpmcRing(unsigned long capacity);
+    };
+
+    /**
+     * Bounded single-producer single-consumer ring, a plain
+     * load and store per call.
+    */
+    template <typename T>
+    class SpscRing
+    {
+    private:
+        std::unique_ptr<T[]> values;
+        unsigned long mask;
+        /* only the producer moves the head, only the
+        consumer the tail */
+        alignas(64) std::atomic<unsigned long> head;
+        alignas(64) std::atomic<unsigned long> tail;
+
+    public:
+        /**
+         * @return false if the ring is full
+        */
+        bool push(const T& value);
+        /**
+         * @return false if the ring is empty
+        */
+        bool pop(T& value);
+        /**
+         * @brief constructor
+         * @param capacity at least this many values, rounded
+         * up to a power of 2
+        */
+        SpscRing(unsigned long capacity);
+    };
+
+    /**
+     * Wait of a stage whose ring is full or empty: spin a
+     * little, then yield, then sleep, so an idle stage
+     * leaves the core to the busy ones.
+    */
+    struct Backoff
+    {
+        unsigned int rounds = 0;
+        void pause();
+        void reset() { rounds = 0; }
+    };
+
+    /**
+     * Puzzles that travel through the pipeline together
+    */
+    struct Chunk
+    {
+        std::vector<BatchJob> jobs;
+        /* jobs in use, the reader fills up to jobs.size() */
+        unsigned int count;
+        /* position in the input, in chunks */
+        unsigned long sequence;
+    };
+
+    /**
+     * @brief solve, count or rate every puzzle of a batch file
+     * as runBatch() does, with the reading, the solving and
+     * the writing overlapped. A reader thread fills chunks of
+     * puzzles and pushes them to the workers, which hand them
+     * to a writer that puts them back in input order. A fixed
+     * set of chunks is recycled from the writer to the reader,
+     * so a slow stage holds the others back and memory stays
+     * flat however long the input. With options.output, each
+     * worker writes the records of its chunks straight to
+     * their offsets and the writer only keeps the tally.
+     * @param filename batch file path, "-" for stdin
+     * @param options what to do, threads is the number of
+     * workers besides the reader and the writer. Phase times
+     * in stats are the busy times of each stage, summed over
+     * workers.
+     * @return 0 if every puzzle is solved, or has exactly one
+     * solution when counting
+    */
+    static int runPipeline(const std::string& filename,
+        const BatchOptions& options);
+
+    /**
+     * @brief the smallest power of 2 not below n
+    */
+    static unsigned long ceilPow2(unsigned long n)
+    {
+        unsigned long capacity = 1;
+        while (capacity < n)
+            capacity <<= 1;
+        return capacity;
+    }
+
+    template <typename T>
+    MpmcRing<T>::MpmcRing(unsigned long capacity)
+        : cells(new Cell[ceilPow2(capacity)]), mask(ceilPow2(capacity) - 1),
+        head(0), tail(0)
+    {
+        for (unsigned long i = 0; i <= mask; i++)
+            cells[i].sequence.store(i, std::memory_order_relaxed);
+    }
+
+    template <typename T>
+    bool MpmcRing<T>::push(const T& value)
+    {
+        unsigned long position = head.load(std::memory_order_relaxed);
+        Cell* cell;
+        while (true)
+        {
+            cell = &cells[position & mask];
+            const long diff = (long)(cell->sequence.load(
+                std::memory_order_acquire) - position);
+            if (diff == 0)
+            {
+                if (head.compare_exchange_weak(position, position + 1,
+                    std::memory_order_relaxed))
+                    break;
+            }
+            /* the cell still holds a value of the last lap */
+            else if (diff < 0)
+                return false;
+            else
+                position = head.load(std::memory_order_relaxed);
+        }
+        cell->value = value;
+        cell->sequence.store(position + 1, std::memory_order_release);
+        return true;
+    }
+
+    template <typename T>
+    bool MpmcRing<T>::pop(T& value)
+    {
+        unsigned long position = tail.load(std::memory_order_relaxed);
+        Cell* cell;
+        while (true)
+        {
+            cell = &cells[position & mask];
+            const long diff = (long)(cell->sequence.load(
+                std::memory_order_acquire) - (position + 1));
+            if (diff == 0)
+            {
+                if (tail.compare_exchange_weak(position, position + 1,
+                    std::memory_order_relaxed))
+                    break;
+            }
+            /* nothing pushed there yet */
+            else if (diff < 0)
+                return false;
+            else
+                position = tail.load(std::memory_order_relaxed);
+        }
+        value = cell->value;
+        /* free the cell for the push one lap later */
+        cell->sequence.store(position + mask + 1, std::memory_order_release);
+        return true;
+    }
+
+    template <typename T>
+    SpscRing<T>::SpscRing(unsigned long capacity)
+        : values(new T[ceilPow2(capacity)]), mask(ceilPow2(capacity) - 1),
+        head(0), tail(0) {}
+
+    template <typename T>
+    bool SpscRing<T>::push(const T& value)
+    {
+        const unsigned long position = head.load(std::memory_order_relaxed);
+        if (position - tail.load(std::memory_order_acquire) > mask)
+            return false;
+        values[position & mask] = value;
+        head.store(position + 1, std::memory_order_release);
+        return true;
+    }
+
+    template <typename T>
+    bool SpscRing<T>::pop(T& value)
+    {
+        const unsigned long position = tail.load(std::memory_order_relaxed);
+        if (head.load(std::memory_order_acquire) == position)
+            return false;
+        value = values[position & mask];
+        tail.store(position + 1, std::memory_order_release);
+        return true;
+    }
+
+    void Backoff::pause()
+    {
+        if (rounds < 64)
+            rounds++;
+        else if (rounds < 128)
+        {
+            rounds++;
+            std::this_thread::yield();
+        }
+        else
+            std::this_thread::sleep_for(std::chrono::microseconds(50));
+    }
+
+    static int runPipeline(const std::string& filename,
+        const BatchOptions& options)
+    {
+        PuzzleReader reader(filename);
+        if (!reader.isOpen())
+            return -1;
+
+        unsigned int workers = options.threads;
+        if (workers == 0)
+            workers = std::thread::hardware_concurrency() == 0 ?
+                1 : std::thread::hardware_concurrency();
+        /* enough chunks for every worker to hold one and have
+        the next queued, while the reader and the writer each
+        hold one */
+        const unsigned int CHUNK = 64;
+        const unsigned long chunks = 4 * workers + 2;
+        std::vector<Chunk> buffers(chunks);
+        SpscRing<Chunk*> freeRing(chunks);
+        /* room for the end markers too */
+        MpmcRing<Chunk*> workRing(chunks + workers);
+        MpmcRing<Chunk*> doneRing(chunks);
+        for (Chunk& chunk : buffers)
+        {
+            chunk.jobs.resize(CHUNK);
+            freeRing.push(&chunk);
+        }
+
+        SolveStats* stats = options.stats;
+        std::vector<SolveContext> contexts(workers);
+        for (SolveContext& context : contexts)
+        {
+            if (stats != nullptr)
+                context.grid.setStats(&context.stats);
+            context.cache = options.cache;
+            context.store = options.store;
+        }
+        /* chunks read, valid once isReadDone is set */
+        unsigned long total = 0;
+        std::atomic<bool> isReadDone(false);
+        auto startTime = std::chrono::steady_clock::now();
+        /* add the time since mark to a phase, and move mark */
+        auto addPhase = [](double& phase_ms,
+            std::chrono::steady_clock::time_point& mark)
+        {
+            auto now = std::chrono::steady_clock::now();
+            phase_ms += std::chrono::duration<double, std::milli>(
+                now - mark).count();
+            mark = now;
+        };
+
+        double read_ms = 0;
+        std::thread readerThread([&]()
+        {
+            Backoff backoff;
+            unsigned long sequence = 0;
+            bool isEnd = false;
+            while (!isEnd)
+            {
+                Chunk* chunk;
+                while (!freeRing.pop(chunk))
+                    backoff.pause();
+                backoff.reset();
+                auto mark = std::chrono::steady_clock::now();
+                chunk->count = 0;
+                while (chunk->count < CHUNK && reader.next(
+                    chunk->jobs[chunk->count].digits,
+                    chunk->jobs[chunk->count].length,
+                    chunk->jobs[chunk->count].format))
+                    chunk->count++;
+                isEnd = chunk->count < CHUNK;
+                /* the first puzzle sets the size of every record */
+                if (options.output != nullptr && sequence == 0 &&
+                    chunk->count != 0)
+                    options.output->setLength(chunk->jobs[0].length);
+                if (stats != nullptr)
+                    addPhase(read_ms, mark);
+                /* an empty last chunk just stays here */
+                if (chunk->count == 0)
+                    break;
+                chunk->sequence = sequence++;
+                /* never full, there are fewer chunks than cells */
+                workRing.push(chunk);
+            }
+            total = sequence;
+            isReadDone.store(true, std::memory_order_release);
+            for (unsigned int k = 0; k < workers; k++)
+                workRing.push(nullptr);
+        });
+
+        std::vector<std::thread> workerThreads;
+        for (unsigned int k = 0; k < workers; k++)
+            workerThreads.emplace_back([&, k]()
+            {
+                SolveContext& context = contexts[k];
+                Backoff backoff;
+                std::string records;
+                while (true)
+                {
+                    Chunk* chunk;
+                    if (!workRing.pop(chunk))
+                    {
+                        backoff.pause();
+                        continue;
+                    }
+                    backoff.reset();
+                    if (chunk == nullptr)
+                        break;
+                    auto mark = std::chrono::steady_clock::now();
+                    for (unsigned int i = 0; i < chunk->count; i++)
+                        runJob(chunk->jobs[i], context, options);
+                    if (stats != nullptr)
+                        addPhase(context.stats.solve_ms, mark);
+                    /* every chunk before this one is full, so its
+                    records start at sequence * CHUNK, written or not */
+                    if (options.output != nullptr)
+                    {
+                        records.clear();
+                        for (unsigned int i = 0; i < chunk->count; i++)
+                            appendJob(chunk->jobs[i], options, records);
+                        options.output->write(chunk->sequence * CHUNK,
+                            records.data(), records.size());
+                        if (stats != nullptr)
+                            addPhase(context.stats.output_ms, mark);
+                    }
+                    doneRing.push(chunk);
+                }
+            });
+
+        /* this thread writes, chunks that arrive early wait
+        in pending, at the slot of their sequence */
+        std::vector<Chunk*> pending(chunks, nullptr);
+        unsigned long next = 0;
+        BatchTally tally;
+        std::string out;
+        double write_ms = 0;
+        Backoff backoff;
+        while (true)
+        {
+            Chunk* chunk;
+            if (!doneRing.pop(chunk))
+            {
+                if (isReadDone.load(std::memory_order_acquire) &&
+                    next == total)
+                    break;
+                backoff.pause();
+                continue;
+            }
+            backoff.reset();
+            auto mark = std::chrono::steady_clock::now();
+            pending[chunk->sequence % chunks] = chunk;
+            while ((chunk = pending[next % chunks]) != nullptr)
+            {
+                for (unsigned int i = 0; i < chunk->count; i++)
+                {
+                    tallyJob(chunk->jobs[i], options, tally);
+                    if (options.output == nullptr)
+                        appendJob(chunk->jobs[i], options, out);
+                }
+                if (out.size() >= (1 << 16))
+                {
+                    std::fwrite(out.data(), 1, out.size(), stdout);
+                    out.clear();
+                }
+                pending[next % chunks] = nullptr;
+                next++;
+                freeRing.push(chunk);
+            }
+            if (stats != nullptr)
+                addPhase(write_ms, mark);
+            traceFlush();
+        }
+        std::fwrite(out.data(), 1, out.size(), stdout);
+        std::fflush(stdout);
+        readerThread.join();
+        for (std::thread& thread : workerThreads)
+            thread.join();
+        if (stats != nullptr)
+        {
+            stats->initialize_ms += read_ms;
+            stats->output_ms += write_ms;
+            for (SolveContext& context : contexts)
+                stats->merge(context.stats);
+        }
+
+        double seconds = std::chrono::duration<double>(
+            std::chrono::steady_clock::now() - startTime).count();
+        return printBatchSummary(options, tally, reader.skipped, seconds,
+            workers);
+    }
+}
\ No newline at end of file
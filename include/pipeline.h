@@ -0,0 +1,4 @@
+#ifndef PIPELINE_H
+#define PIPELINE_H
+#include "pipeline.cxx"
+#endif
\ No newline at end of file
@@ -0,0 +1,239 @@
+/*******************************************
+ * @title   Rater
+ * @brief   rate puzzles by the hardest rule
+ * their solve takes
+ * @author  Bin Qu
+ * @date    2026.10.17
+ * @copyright   You can edit and remodify
+ * this file.
+*******************************************/
+
+#include "element.h"
+#include "FixedGrid.h"
+#include "solver.h"
+
+#include <vector>
+
+namespace sds
+{
+    /**
+     * Rules of the difficulty ladder, from the cheapest on
+    */
+    enum RateRule
+    {
+        /* the puzzle was already complete */
+        rule_none,
+        rule_naked_single,
+        rule_hidden_single,
+        rule_naked_subset,
+        rule_hidden_subset,
+        /* the rules stall and a guess is needed */
+        rule_search,
+        /* the clues contradict */
+        rule_unsolvable
+    };
+
+    /**
+     * How hard a puzzle was to solve
+    */
+    struct Rating
+    {
+        /* the hardest rule that made progress */
+        RateRule rule;
+        /* the largest subset size that made progress, 1 for
+        singles */
+        unsigned int max_ie;
+        /* search nodes once the rules stall, 0 if they do not */
+        unsigned long nodes;
+        /* cost of the hardest step, see rateCost() */
+        unsigned long score;
+    };
+
+    /**
+     * @brief the name of a rule, as printed by --rate
+    */
+    static const char* ruleName(RateRule rule);
+
+    /**
+     * @brief cost of one step: 1 for a naked single, 2 for a
+     * hidden single, 2k and 2k + 1 for a naked and a hidden
+     * subset of size k. A guess costs 2 * length + 2 plus
+     * the search nodes, more than any rule.
+    */
+    static unsigned long rateCost(RateRule rule, unsigned int ie,
+        unsigned int length, unsigned long nodes);
+
+    /**
+     * @brief apply the cheapest rule that makes progress,
+     * over and over, recording the hardest one. Works on
+     * Grid and FixedGrid alike.
+     * @param grid grid whose mask is initialized
+     * @param length grid size length
+     * @param rating receives rule, max_ie and score
+     * @return false if the grid turns out to be unsolvable
+    */
+    template <typename G>
+    static bool rateRules(G& grid, unsigned int length, Rating& rating);
+
+    /**
+     * @brief rate a grid with a FixedGrid specialization. Its
+     * buffers are kept per thread and reused.
+     * @param grid grid loaded with clues, left unchanged
+     * @param rating the rating
+    */
+    template <unsigned int N, typename Word>
+    static void rateFixed(Grid& grid, Rating& rating);
+
+    /**
+     * @brief rate a grid with the generic Grid rules
+     * @param grid grid loaded with clues, holds the solution
+     * afterwards if there is one
+     * @param searcher searcher whose buffers are reused
+     * @param rating the rating
+    */
+    static void rateGrid(Grid& grid, Searcher& searcher, Rating& rating);
+
+    /**
+     * @brief rate a grid with the FixedGrid specialization
+     * that fits its size, or with the generic Grid rules
+     * if there is none.
+     * @param grid grid loaded with clues
+     * @param searcher searcher used by the generic fallback
+     * @param rating the rating
+    */
+    static void rateDispatch(Grid& grid, Searcher& searcher, Rating& rating);
+
+    static const char* ruleName(RateRule rule)
+    {
+        static const char* names[] = {"none", "naked_single",
+            "hidden_single", "naked_subset", "hidden_subset", "search",
+            "unsolvable"};
+        return names[rule];
+    }
+
+    static unsigned long rateCost(RateRule rule, unsigned int ie,
+        unsigned int length, unsigned long nodes)
+    {
+        switch (rule)
+        {
+        case rule_naked_single:
+            return 1;
+        case rule_hidden_single:
+            return 2;
+        case rule_naked_subset:
+            return 2 * ie;
+        case rule_hidden_subset:
+            return 2 * ie + 1;
+        case rule_search:
+            return 2 * length + 2 + nodes;
+        default:
+            return 0;
+        }
+    }
+
+    template <typename G>
+    static bool rateRules(G& grid, unsigned int length, Rating& rating)
+    {
+        rating.rule = rule_none;
+        rating.max_ie = 0;
+        rating.nodes = 0;
+        rating.score = 0;
+        /* record a step that made progress */
+        auto step = [&rating, length](RateRule rule, unsigned int ie)
+        {
+            const unsigned long cost = rateCost(rule, ie, length, 0);
+            if (cost > rating.score)
+            {
+                rating.score = cost;
+                rating.rule = rule;
+            }
+            if (ie > rating.max_ie)
+                rating.max_ie = ie;
+        };
+        unsigned int ie = 2;
+        while (true)
+        {
+            /* one naked single pass at a time, so a hidden
+            single is only taken when no naked one is left */
+            if (grid.fill())
+            {
+                step(rule_naked_single, 1);
+                ie = 2;
+                continue;
+            }
+            if (grid.isCompleted())
+                return true;
+            if (grid.hasDeadLattice())
+                return false;
+            if (grid.hiding(1))
+            {
+                step(rule_hidden_single, 1);
+                ie = 2;
+                continue;
+            }
+            if (ie > length)
+                return true;
+            if (grid.excluding(ie))
+            {
+                step(rule_naked_subset, ie);
+                ie = 2;
+                continue;
+            }
+            if (grid.hiding(ie))
+            {
+                step(rule_hidden_subset, ie);
+                ie = 2;
+                continue;
+            }
+            ie++;
+        }
+    }
+
+    template <unsigned int N, typename Word>
+    static void rateFixed(Grid& grid, Rating& rating)
+    {
+        static thread_local std::vector<FixedGrid<N, Word>> fixed(1);
+        FixedGrid<N, Word>& f = fixed[0];
+        if (!f.load(grid.Lattices()) || !rateRules(f, N, rating))
+        {
+            rating.rule = rule_unsolvable;
+            rating.score = 0;
+            return;
+        }
+        if (f.isCompleted())
+            return;
+        /* the rules stalled, search from where they stopped */
+        const bool isSolved = f.hasSolution(~0UL);
+        rating.nodes = f.Nodes();
+        rating.rule = isSolved ? rule_search : rule_unsolvable;
+        rating.score = isSolved ? rateCost(rule_search, 0, N, f.Nodes()) : 0;
+    }
+
+    static void rateGrid(Grid& grid, Searcher& searcher, Rating& rating)
+    {
+        grid.initializeMask();
+        if (!rateRules(grid, grid.Length(), rating))
+        {
+            rating.rule = rule_unsolvable;
+            rating.score = 0;
+            return;
+        }
+        if (grid.isCompleted())
+            return;
+        const bool isSolved = searcher.search(grid);
+        rating.nodes = searcher.Nodes();
+        rating.rule = isSolved ? rule_search : rule_unsolvable;
+        rating.score = isSolved ?
+            rateCost(rule_search, 0, grid.Length(), searcher.Nodes()) : 0;
+    }
+
+    static void rateDispatch(Grid& grid, Searcher& searcher, Rating& rating)
+    {
+        dispatchFixed(grid.Length(), [&](auto size)
+        {
+            typedef decltype(size) Size;
+            rateFixed<Size::N, typename Size::Word>(grid, rating);
+        },
+        [&]() { rateGrid(grid, searcher, rating); });
+    }
+}
\ No newline at end of file
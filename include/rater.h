@@ -0,0 +1,4 @@
+#ifndef RATER_H
+#define RATER_H
+#include "rater.cxx"
+#endif
\ No newline at end of file
@@ -0,0 +1,398 @@
+/*******************************************
+ * @title   Server
+ * @brief   keep solver contexts warm and answer
+ * one puzzle per line over a stream
+ * @author  Bin Qu
+ * @date    2026.10.17
+ * @copyright   You can edit and remodify
+ * this file.
+*******************************************/
+
+#include "library.h"
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <condition_variable>
+#include <csignal>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace sds
+{
+    /**
+     * A solver daemon. Requests are one-line puzzles and each
+     * gets one line back, in order: the solution in the layout
+     * of the puzzle, "unsolvable" or "invalid". Whatever a read
+     * returns is answered as one batch, so pipelined requests
+     * cost one write, and a batch large enough is spread over
+     * the workers.
+    */
+    class Server
+    {
+    public:
+        /**
+         * @brief the longest request line, longer ones are
+         * answered "invalid"
+        */
+        static constexpr std::size_t MAX_LINE = 1 << 20;
+        /**
+         * @brief batches with fewer requests are solved by
+         * the connection thread alone
+        */
+        static constexpr unsigned int MIN_SPLIT = 16;
+
+    private:
+        /**
+         * @brief use dancing links instead of the logic engine
+        */
+        bool isDLX;
+        /**
+         * @brief workers big batches are spread over, none if
+         * there is a single thread
+        */
+        std::unique_ptr<ThreadPool> pool;
+        /**
+         * @brief one context per pool worker
+        */
+        std::vector<SolverContext> contexts;
+        /**
+         * @brief solutions shared by every context, may be nullptr
+        */
+        SolutionCache* cache;
+        /**
+         * @brief solution store file, may be nullptr
+        */
+        SolutionStore* store;
+        /**
+         * @brief connection threads still running, they use
+         * this server until they end
+        */
+        unsigned int connections;
+        std::mutex connectionLock;
+        std::condition_variable connectionDone;
+
+        /**
+         * @brief answer one request
+         * @param solver context of the calling thread
+         * @param line request without its line ending
+         * @param length the number of bytes of line
+         * @param out receives the answer and "\r\n"
+        */
+        static void answer(SolverContext& solver, const char* line,
+            std::size_t length, std::string& out);
+        /**
+         * @brief answer a batch of requests in order
+         * @param solver context of the connection thread
+         * @param buf the bytes the requests point into
+         * @param lines offset and length of each request
+         * @param answers one buffer per request, reused
+         * @param out receives every answer
+        */
+        void answerBatch(SolverContext& solver, const char* buf,
+            const std::vector<std::pair<std::size_t, std::size_t>>& lines,
+            std::vector<std::string>& answers, std::string& out);
+        /**
+         * @brief write all of out, retrying short writes
+         * @return false if the peer is gone
+        */
+        static bool writeAll(int fd, const std::string& out);
+
+    public:
+        /**
+         * @brief serve requests from one stream until it ends
+         * @param in file descriptor requests are read from
+         * @param out file descriptor answers are written to
+        */
+        void serveStream(int in, int out);
+        /**
+         * @brief accept connections on a Unix domain socket,
+         * one thread per connection, until accept() fails.
+         * Connections still open are served to their end
+         * before it returns.
+         * @param path socket path, a stale socket there is
+         * replaced
+         * @return -1 on error
+        */
+        int serveSocket(const char* path);
+        /**
+         * @brief constructor
+         * @param isDLX use dancing links instead of the logic
+         * engine
+         * @param threads the number of workers, 0 for one per
+         * hardware thread, 1 to solve on connection threads only
+         * @param cache solution cache, nullptr for none
+         * @param store solution store, nullptr for none
+        */
+        Server(bool isDLX, unsigned int threads, SolutionCache* cache,
+            SolutionStore* store);
+    };
+
+    /**
+     * @brief run a server until its input ends
+     * @param path Unix domain socket path, nullptr to serve
+     * stdin/stdout
+     * @param isDLX use dancing links instead of the logic engine
+     * @param threads the number of workers
+     * @param cache solution cache, nullptr for none
+     * @param store solution store, nullptr for none
+     * @return 0 on a clean end, -1 on error
+    */
+    static int runServe(const char* path, bool isDLX, unsigned int threads,
+        SolutionCache* cache = nullptr, SolutionStore* store = nullptr);
+
+    Server::Server(bool isDLX, unsigned int threads, SolutionCache* cache,
+        SolutionStore* store) : isDLX(isDLX), cache(cache), store(store),
+        connections(0)
+    {
+        if (threads != 1)
+            pool.reset(new ThreadPool(threads));
+        contexts.resize(pool ? pool->Size() : 0);
+        for (SolverContext& context : contexts)
+        {
+            context.setDLX(isDLX);
+            context.setCache(cache);
+            context.setStore(store);
+        }
+    }
+
+    void Server::answer(SolverContext& solver, const char* line,
+        std::size_t length, std::string& out)
+    {
+        if (length >= MAX_LINE)
+        {
+            out += "invalid\r\n";
+            return;
+        }
+        switch (solver.solveText(line, length))
+        {
+        case SDS_SOLVED:
+            out += solver.Text();
+            break;
+        case SDS_UNSOLVABLE:
+            out += "unsolvable";
+            break;
+        default:
+            out += "invalid";
+            break;
+        }
+        out += "\r\n";
+    }
+
+    void Server::answerBatch(SolverContext& solver, const char* buf,
+        const std::vector<std::pair<std::size_t, std::size_t>>& lines,
+        std::vector<std::string>& answers, std::string& out)
+    {
+        const unsigned int count = lines.size();
+        if (!pool || count < MIN_SPLIT)
+        {
+            for (unsigned int k = 0; k < count; k++)
+                answer(solver, buf + lines[k].first, lines[k].second, out);
+            return;
+        }
+
+        /* one chunk per worker plus one for this thread */
+        if (answers.size() < count)
+            answers.resize(count);
+        const unsigned int chunks = pool->Size() + 1;
+        const unsigned int chunk = (count + chunks - 1) / chunks;
+        std::mutex lock;
+        std::condition_variable cond;
+        /* chunks the workers take, set before any of them ends */
+        unsigned int remaining = (count - 1) / chunk;
+        for (unsigned int first = chunk; first < count; first += chunk)
+        {
+            const unsigned int last = std::min(first + chunk, count);
+            pool->submit([&, first, last](unsigned int worker)
+            {
+                for (unsigned int k = first; k < last; k++)
+                {
+                    answers[k].clear();
+                    answer(contexts[worker], buf + lines[k].first,
+                        lines[k].second, answers[k]);
+                }
+                std::lock_guard<std::mutex> guard(lock);
+                if (--remaining == 0)
+                    cond.notify_one();
+            });
+        }
+        for (unsigned int k = 0; k < chunk; k++)
+            answer(solver, buf + lines[k].first, lines[k].second, out);
+        std::unique_lock<std::mutex> guard(lock);
+        cond.wait(guard, [&remaining]() { return remaining == 0; });
+        for (unsigned int k = chunk; k < count; k++)
+            out += answers[k];
+    }
+
+    bool Server::writeAll(int fd, const std::string& out)
+    {
+        std::size_t done = 0;
+        while (done < out.size())
+        {
+            const ssize_t n = write(fd, out.data() + done, out.size() - done);
+            if (n < 0 && errno == EINTR)
+                continue;
+            if (n <= 0)
+                return false;
+            done += n;
+        }
+        return true;
+    }
+
+    void Server::serveStream(int in, int out)
+    {
+        SolverContext solver;
+        solver.setDLX(isDLX);
+        solver.setCache(cache);
+        solver.setStore(store);
+        std::vector<char> buf(1 << 16);
+        std::vector<std::pair<std::size_t, std::size_t>> lines;
+        std::vector<std::string> answers;
+        std::string text;
+        /* bytes in buf, and how many were scanned for '\n' */
+        std::size_t length = 0;
+        std::size_t scanned = 0;
+        /* a request outgrew MAX_LINE, skip to its end */
+        bool isSkipping = false;
+        bool isEnd = false;
+        while (!isEnd)
+        {
+            if (length == buf.size())
+                buf.resize(buf.size() * 2);
+            const ssize_t n = read(in, buf.data() + length,
+                buf.size() - length);
+            if (n < 0 && errno == EINTR)
+                continue;
+            if (n <= 0)
+            {
+                /* answer a last request without a line ending */
+                isEnd = true;
+                if (length == 0)
+                    break;
+                buf.insert(buf.begin() + length, '\n');
+                length++;
+            }
+            else
+                length += n;
+
+            /* split what arrived into requests */
+            lines.clear();
+            text.clear();
+            std::size_t start = 0;
+            for (std::size_t i = scanned; i < length; i++)
+            {
+                if (buf[i] != '\n')
+                    continue;
+                std::size_t end = i;
+                if (end > start && buf[end - 1] == '\r')
+                    end--;
+                if (isSkipping)
+                    isSkipping = false;
+                else if (end > start)
+                    lines.emplace_back(start, end - start);
+                start = i + 1;
+            }
+            if (!isSkipping && length - start >= MAX_LINE)
+            {
+                /* answer it now so the buffer stays bounded */
+                lines.emplace_back(start, MAX_LINE);
+                isSkipping = true;
+            }
+
+            answerBatch(solver, buf.data(), lines, answers, text);
+            if (!text.empty() && !writeAll(out, text))
+                break;
+
+            /* keep the unfinished request */
+            if (isSkipping)
+                start = length;
+            std::memmove(buf.data(), buf.data() + start, length - start);
+            length -= start;
+            scanned = length;
+        }
+    }
+
+    int Server::serveSocket(const char* path)
+    {
+        sockaddr_un addr;
+        std::memset(&addr, 0, sizeof(addr));
+        addr.sun_family = AF_UNIX;
+        if (std::strlen(path) >= sizeof(addr.sun_path))
+        {
+            std::fprintf(stderr, "socket path \"%s\" is too long\r\n", path);
+            return -1;
+        }
+        std::strcpy(addr.sun_path, path);
+
+        const int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (fd < 0)
+        {
+            std::perror("socket");
+            return -1;
+        }
+        /* a socket left by an earlier run, never a regular file */
+        struct stat st;
+        if (stat(path, &st) == 0 && S_ISSOCK(st.st_mode))
+            unlink(path);
+        if (bind(fd, (sockaddr*)&addr, sizeof(addr)) != 0 ||
+            listen(fd, SOMAXCONN) != 0)
+        {
+            std::perror(path);
+            close(fd);
+            return -1;
+        }
+        std::fprintf(stderr, "serve: listening on %s\r\n", path);
+        while (true)
+        {
+            const int connection = accept(fd, nullptr, nullptr);
+            if (connection < 0)
+            {
+                if (errno == EINTR || errno == ECONNABORTED)
+                    continue;
+                std::perror("accept");
+                break;
+            }
+            {
+                std::lock_guard<std::mutex> guard(connectionLock);
+                connections++;
+            }
+            std::thread([this, connection]()
+            {
+                serveStream(connection, connection);
+                close(connection);
+                /* notify under the lock, the server may be gone
+                once the waiter sees zero */
+                std::lock_guard<std::mutex> guard(connectionLock);
+                connections--;
+                connectionDone.notify_all();
+            }).detach();
+        }
+        close(fd);
+        unlink(path);
+        std::unique_lock<std::mutex> guard(connectionLock);
+        connectionDone.wait(guard, [this]() { return connections == 0; });
+        return -1;
+    }
+
+    static int runServe(const char* path, bool isDLX, unsigned int threads,
+        SolutionCache* cache, SolutionStore* store)
+    {
+        /* a peer that hangs up must not kill the daemon */
+        std::signal(SIGPIPE, SIG_IGN);
+        Server server(isDLX, threads, cache, store);
+        if (path != nullptr)
+            return server.serveSocket(path);
+        server.serveStream(0, 1);
+        return 0;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,4 @@
+#ifndef SERVER_H
+#define SERVER_H
+#include "server.cxx"
+#endif
\ No newline at end of file
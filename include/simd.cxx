@@ -0,0 +1,307 @@
+/*******************************************
+ * @title   SIMD
+ * @brief   vectorized kernels that AND candidate
+ * masks, picked at runtime by CPUID
+ * @author  Bin Qu
+ * @date    2026.10.17
+ * @copyright   You can edit and remodify
+ * this file.
+*******************************************/
+
+#include <cstddef>
+#include <cstring>
+#include <cstdint>
+
+#if !defined(SDS_NO_SIMD) && defined(__GNUC__) && \
+    (defined(__x86_64__) || defined(__i386__))
+#define SDS_X86_SIMD
+#include <immintrin.h>
+#endif
+
+namespace sds
+{
+    /**
+     * @brief mask kernels of one instruction set
+    */
+    struct MaskKernels
+    {
+        /**
+         * @brief dst[i] &= src[i] for n bytes
+        */
+        void (*andBytes)(unsigned char* dst, const unsigned char* src,
+            std::size_t n);
+        /**
+         * @brief dst[i] &= pattern[i % cell_len] over cells
+         * lattices laid out back to back
+        */
+        void (*andPattern)(unsigned char* dst, const unsigned char* pattern,
+            unsigned int cell_len, unsigned int cells);
+        /**
+         * @brief instruction set name
+        */
+        const char* name;
+    };
+
+    /**
+     * @brief text scanning kernels of one instruction set
+    */
+    struct TextKernels
+    {
+        /**
+         * @brief skip ',', ' ', '\t' and '\r'
+         * @return the first other byte in [p, end), or end
+        */
+        const char* (*skipSeparators)(const char* p, const char* end);
+        /**
+         * @brief instruction set name
+        */
+        const char* name;
+    };
+
+    /**
+     * @brief the best kernels this cpu supports,
+     * chosen once at first call
+    */
+    static const MaskKernels& maskKernels();
+    /**
+     * @brief the best text kernels this cpu supports,
+     * chosen once at first call
+    */
+    static const TextKernels& textKernels();
+
+    /**
+     * @brief dst[k * stride + j] &= pattern[j], j < cell_len,
+     * for count lattices, e.g. a column of the mask
+     * @param stride distance in bytes between two lattices
+    */
+    static inline void andStrided(unsigned char* dst, std::size_t stride,
+        unsigned int count, const unsigned char* pattern,
+        unsigned int cell_len);
+
+    static void andBytesScalar(unsigned char* dst, const unsigned char* src,
+        std::size_t n)
+    {
+        std::size_t i = 0;
+        /* a word at a time, memcpy keeps it alignment-safe */
+        for (; i + 8 <= n; i += 8)
+        {
+            std::uint64_t a, b;
+            std::memcpy(&a, dst + i, 8);
+            std::memcpy(&b, src + i, 8);
+            a &= b;
+            std::memcpy(dst + i, &a, 8);
+        }
+        for (; i < n; i++)
+            dst[i] &= src[i];
+    }
+
+    static void andPatternScalar(unsigned char* dst,
+        const unsigned char* pattern, unsigned int cell_len,
+        unsigned int cells)
+    {
+        for (unsigned int k = 0; k < cells; k++)
+            for (unsigned int j = 0; j < cell_len; j++)
+                dst[k * cell_len + j] &= pattern[j];
+    }
+
+    static inline bool isSeparator(char c)
+    { return c == ',' || c == ' ' || c == '\t' || c == '\r'; }
+
+    static const char* skipSeparatorsScalar(const char* p, const char* end)
+    {
+        while (p < end && isSeparator(*p))
+            p++;
+        return p;
+    }
+
+#ifdef SDS_X86_SIMD
+    /**
+     * @brief repeat a pattern of cell_len bytes over n bytes,
+     * doubling the copied prefix instead of a modulo per byte
+    */
+    static inline void repeatPattern(unsigned char* wide, unsigned int n,
+        const unsigned char* pattern, unsigned int cell_len)
+    {
+        std::memcpy(wide, pattern, cell_len);
+        for (unsigned int filled = cell_len; filled < n; filled *= 2)
+            std::memcpy(wide + filled, wide,
+                filled < n - filled ? filled : n - filled);
+    }
+
+    /*
+     * andPattern kernels repeat the pattern over one vector starting at
+     * phase 0 and step by the largest multiple of cell_len that fits,
+     * so consecutive stores may overlap; AND is idempotent and the
+     * overlapped bytes see the same phase, so the result is unchanged.
+    */
+
+    __attribute__((target("sse2")))
+    static void andBytesSSE2(unsigned char* dst, const unsigned char* src,
+        std::size_t n)
+    {
+        std::size_t i = 0;
+        for (; i + 16 <= n; i += 16)
+        {
+            __m128i a = _mm_loadu_si128((const __m128i*)(dst + i));
+            __m128i b = _mm_loadu_si128((const __m128i*)(src + i));
+            _mm_storeu_si128((__m128i*)(dst + i), _mm_and_si128(a, b));
+        }
+        andBytesScalar(dst + i, src + i, n - i);
+    }
+
+    __attribute__((target("sse2")))
+    static void andPatternSSE2(unsigned char* dst,
+        const unsigned char* pattern, unsigned int cell_len,
+        unsigned int cells)
+    {
+        const std::size_t n = (std::size_t)cell_len * cells;
+        if (cell_len > 16 || n < 16)
+        {
+            for (unsigned int k = 0; k < cells; k++)
+                andBytesSSE2(dst + k * cell_len, pattern, cell_len);
+            return;
+        }
+        alignas(16) unsigned char wide[16];
+        repeatPattern(wide, 16, pattern, cell_len);
+        const __m128i p = _mm_load_si128((const __m128i*)wide);
+        const std::size_t step = 16 - 16 % cell_len;
+        std::size_t i = 0;
+        for (; i + 16 <= n; i += step)
+        {
+            __m128i a = _mm_loadu_si128((const __m128i*)(dst + i));
+            _mm_storeu_si128((__m128i*)(dst + i), _mm_and_si128(a, p));
+        }
+        /* i stays on a lattice boundary, finish the last few */
+        andPatternScalar(dst + i, pattern, cell_len,
+            (unsigned int)((n - i) / cell_len));
+    }
+
+    __attribute__((target("avx2")))
+    static void andBytesAVX2(unsigned char* dst, const unsigned char* src,
+        std::size_t n)
+    {
+        std::size_t i = 0;
+        for (; i + 32 <= n; i += 32)
+        {
+            __m256i a = _mm256_loadu_si256((const __m256i*)(dst + i));
+            __m256i b = _mm256_loadu_si256((const __m256i*)(src + i));
+            _mm256_storeu_si256((__m256i*)(dst + i), _mm256_and_si256(a, b));
+        }
+        andBytesSSE2(dst + i, src + i, n - i);
+    }
+
+    __attribute__((target("avx2")))
+    static void andPatternAVX2(unsigned char* dst,
+        const unsigned char* pattern, unsigned int cell_len,
+        unsigned int cells)
+    {
+        const std::size_t n = (std::size_t)cell_len * cells;
+        if (cell_len > 32 || n < 32)
+        {
+            if (cell_len > 32)
+                for (unsigned int k = 0; k < cells; k++)
+                    andBytesAVX2(dst + k * cell_len, pattern, cell_len);
+            else
+                andPatternSSE2(dst, pattern, cell_len, cells);
+            return;
+        }
+        alignas(32) unsigned char wide[32];
+        repeatPattern(wide, 32, pattern, cell_len);
+        const __m256i p = _mm256_load_si256((const __m256i*)wide);
+        const std::size_t step = 32 - 32 % cell_len;
+        std::size_t i = 0;
+        for (; i + 32 <= n; i += step)
+        {
+            __m256i a = _mm256_loadu_si256((const __m256i*)(dst + i));
+            _mm256_storeu_si256((__m256i*)(dst + i), _mm256_and_si256(a, p));
+        }
+        if (i < n)
+            andPatternSSE2(dst + i, pattern, cell_len,
+                (unsigned int)((n - i) / cell_len));
+    }
+
+    __attribute__((target("sse2")))
+    static const char* skipSeparatorsSSE2(const char* p, const char* end)
+    {
+        const __m128i comma = _mm_set1_epi8(',');
+        const __m128i space = _mm_set1_epi8(' ');
+        const __m128i tab = _mm_set1_epi8('\t');
+        const __m128i cr = _mm_set1_epi8('\r');
+        for (; p + 16 <= end; p += 16)
+        {
+            const __m128i v = _mm_loadu_si128((const __m128i*)p);
+            const __m128i sep = _mm_or_si128(
+                _mm_or_si128(_mm_cmpeq_epi8(v, comma), _mm_cmpeq_epi8(v, space)),
+                _mm_or_si128(_mm_cmpeq_epi8(v, tab), _mm_cmpeq_epi8(v, cr)));
+            const unsigned int other = ~_mm_movemask_epi8(sep) & 0xFFFF;
+            if (other != 0)
+                return p + __builtin_ctz(other);
+        }
+        return skipSeparatorsScalar(p, end);
+    }
+
+    __attribute__((target("avx2")))
+    static const char* skipSeparatorsAVX2(const char* p, const char* end)
+    {
+        const __m256i comma = _mm256_set1_epi8(',');
+        const __m256i space = _mm256_set1_epi8(' ');
+        const __m256i tab = _mm256_set1_epi8('\t');
+        const __m256i cr = _mm256_set1_epi8('\r');
+        for (; p + 32 <= end; p += 32)
+        {
+            const __m256i v = _mm256_loadu_si256((const __m256i*)p);
+            const __m256i sep = _mm256_or_si256(
+                _mm256_or_si256(_mm256_cmpeq_epi8(v, comma),
+                    _mm256_cmpeq_epi8(v, space)),
+                _mm256_or_si256(_mm256_cmpeq_epi8(v, tab),
+                    _mm256_cmpeq_epi8(v, cr)));
+            const unsigned int other = ~(unsigned int)_mm256_movemask_epi8(sep);
+            if (other != 0)
+                return p + __builtin_ctz(other);
+        }
+        return skipSeparatorsSSE2(p, end);
+    }
+#endif
+
+    static const TextKernels& textKernels()
+    {
+        static const TextKernels kernels = []()
+        {
+#ifdef SDS_X86_SIMD
+            __builtin_cpu_init();
+            if (__builtin_cpu_supports("avx2"))
+                return TextKernels{skipSeparatorsAVX2, "avx2"};
+            if (__builtin_cpu_supports("sse2"))
+                return TextKernels{skipSeparatorsSSE2, "sse2"};
+#endif
+            return TextKernels{skipSeparatorsScalar, "scalar"};
+        }();
+        return kernels;
+    }
+
+    static const MaskKernels& maskKernels()
+    {
+        static const MaskKernels kernels = []()
+        {
+#ifdef SDS_X86_SIMD
+            __builtin_cpu_init();
+            if (__builtin_cpu_supports("avx2"))
+                return MaskKernels{andBytesAVX2, andPatternAVX2, "avx2"};
+            if (__builtin_cpu_supports("sse2"))
+                return MaskKernels{andBytesSSE2, andPatternSSE2, "sse2"};
+#endif
+            return MaskKernels{andBytesScalar, andPatternScalar, "scalar"};
+        }();
+        return kernels;
+    }
+
+    static inline void andStrided(unsigned char* dst, std::size_t stride,
+        unsigned int count, const unsigned char* pattern,
+        unsigned int cell_len)
+    {
+        /* lattices are too short to fill a vector, keep it scalar */
+        for (unsigned int k = 0; k < count; k++)
+            for (unsigned int j = 0; j < cell_len; j++)
+                dst[k * stride + j] &= pattern[j];
+    }
+}
\ No newline at end of file
@@ -0,0 +1,4 @@
+#ifndef SIMD_H
+#define SIMD_H
+#include "simd.cxx"
+#endif
\ No newline at end of file
@@ -0,0 +1,272 @@
+/*******************************************
+ * @title   Solver
+ * @brief   logic propagation and backtracking
+ * search on top of Grid
+ * @author  Bin Qu
+ * @date    2026.10.17
+ * @copyright   You can edit and remodify
+ * this file.
+*******************************************/
+
+#include "element.h"
+
+#include <atomic>
+#include <functional>
+
+namespace sds
+{
+    /**
+     * @brief called with the row-major lattices of each
+     * solution a count finds
+    */
+    typedef std::function<void(const char* lattices)> SolutionCallback;
+
+    /**
+     * @brief run fill(), hidden singles, i-excluding and
+     * hidden subsets until no rule makes any progress.
+     * Cheaper rules are always retried first.
+     * @param grid grid whose mask is initialized
+     * @param max_ie the largest i tried by i-excluding
+     * @return false if the grid turns out to be unsolvable
+    */
+    static bool propagate(Grid& grid, unsigned int max_ie);
+
+    /**
+     * Backtracking search that guesses the lattice with
+     * the fewest candidates and propagates after each guess.
+     * Guesses are rolled back through the grid's trail, so a
+     * branch costs the bytes it changed, not a copy of the grid.
+    */
+    class Searcher
+    {
+    private:
+        /**
+         * @brief the largest i tried by i-excluding
+         * inside the search tree
+        */
+        unsigned int max_ie;
+        /**
+         * @brief the number of visited search nodes
+        */
+        unsigned long nodes = 0;
+        /**
+         * @brief search gives up once the flag is set
+        */
+        const std::atomic<bool>* stopFlag = nullptr;
+        /**
+         * @brief search stops once this many solutions
+         * are found
+        */
+        unsigned long limit = 1;
+        /**
+         * @brief the number of solutions found
+        */
+        unsigned long solutions = 0;
+        /**
+         * @brief called with each solution, may be nullptr
+        */
+        const SolutionCallback* onSolution = nullptr;
+
+        /**
+         * @brief count the solution the grid holds
+         * @return have limit solutions been found?
+        */
+        bool foundSolution(Grid& grid);
+
+        /**
+         * @brief search recursively
+         * @param grid grid to solve
+         * @param depth depth of the search tree
+         * @return is the grid solved?
+        */
+        bool searchNode(Grid& grid, unsigned int depth);
+
+    public:
+        /**
+         * @brief find the empty lattice with the fewest
+         * candidates
+         * @param grid grid to scan
+         * @return 1-d address of the lattice
+        */
+        static unsigned int pickLattice(Grid& grid);
+        /**
+         * @brief solve the grid, leaving the solution
+         * in it if there is any.
+         * @param grid grid whose mask is initialized
+         * @return is the grid solved?
+        */
+        bool search(Grid& grid);
+        /**
+         * @brief search every branch and count solutions
+         * @param grid grid whose mask is initialized, holds
+         * the last solution found if limit is reached
+         * @param limit stop once this many are found
+         * @param onSolution called with each solution, may
+         * be nullptr
+         * @return the number of solutions, at most limit
+        */
+        unsigned long count(Grid& grid, unsigned long limit,
+            const SolutionCallback* onSolution);
+        /**
+         * @brief the number of search nodes visited by
+         * the last search() or count()
+        */
+        unsigned long Nodes() { return nodes; }
+        /**
+         * @brief let another thread cancel the search
+         * @param flag flag that is set to cancel, nullptr
+         * for none
+        */
+        void setStopFlag(const std::atomic<bool>* flag) { stopFlag = flag; }
+        /**
+         * @brief constructor
+         * @param max_ie the largest i tried by i-excluding
+         * after each guess
+        */
+        Searcher(unsigned int max_ie = 2) : max_ie(max_ie) { }
+    };
+
+    /**
+     * @brief solve a freshly loaded grid: initialize mask,
+     * propagate, and search if logic stalls.
+     * @param grid grid loaded with clues
+     * @param searcher searcher whose buffers are reused
+     * @return is the grid solved?
+    */
+    static bool solveGrid(Grid& grid, Searcher& searcher);
+
+    /**
+     * @brief count the solutions of a freshly loaded grid
+     * @param grid grid loaded with clues, holds the solution
+     * if limit is 1 and there is one
+     * @param searcher searcher whose buffers are reused
+     * @param limit stop once this many are found
+     * @param onSolution called with each solution, may be
+     * nullptr
+     * @return the number of solutions, at most limit
+    */
+    static unsigned long countGrid(Grid& grid, Searcher& searcher,
+        unsigned long limit, const SolutionCallback* onSolution);
+
+    static bool propagate(Grid& grid, unsigned int max_ie)
+    {
+        unsigned int ie = 2;
+        while (true)
+        {
+            while (grid.fill()) { }
+            if (grid.isCompleted())
+                return true;
+            if (grid.hasDeadLattice())
+                return false;
+            if (grid.hiding(1))
+            {
+                ie = 2;
+                continue;
+            }
+            if (ie > max_ie || ie > grid.Length())
+                return !grid.hasDeadLattice();
+            if (grid.excluding(ie) || grid.hiding(ie))
+            {
+                ie = 2;
+                continue;
+            }
+            ie++;
+        }
+    }
+
+    bool Searcher::search(Grid& grid)
+    { return count(grid, 1, nullptr) == 1; }
+
+    unsigned long Searcher::count(Grid& grid, unsigned long limit,
+        const SolutionCallback* onSolution)
+    {
+        nodes = 0;
+        solutions = 0;
+        this->limit = limit;
+        this->onSolution = onSolution;
+        searchNode(grid, 0);
+        return solutions;
+    }
+
+    bool Searcher::foundSolution(Grid& grid)
+    {
+        solutions++;
+        if (onSolution != nullptr)
+            (*onSolution)(grid.Lattices());
+        return solutions >= limit;
+    }
+
+    unsigned int Searcher::pickLattice(Grid& grid)
+    {
+        const unsigned int sizegrid = grid.Size();
+        unsigned int best = sizegrid;
+        unsigned int bestCount = grid.Length() + 1;
+        unsigned int tmpCount;
+        for (unsigned int i = 0; i < sizegrid; i++)
+        {
+            if (grid(i / grid.Length(), i % grid.Length()) != 0)
+                continue;
+            tmpCount = grid.countCandidates(i);
+            if (tmpCount < bestCount)
+            {
+                best = i;
+                bestCount = tmpCount;
+                /* a lattice with 2 candidates is the best we can get */
+                if (bestCount <= 2)
+                    break;
+            }
+        }
+        return best;
+    }
+
+    bool Searcher::searchNode(Grid& grid, unsigned int depth)
+    {
+        nodes++;
+        if (stopFlag != nullptr && stopFlag->load(std::memory_order_relaxed))
+            return false;
+        if (!propagate(grid, max_ie))
+            return false;
+        if (grid.isCompleted())
+            return foundSolution(grid);
+
+        const unsigned int lattice = pickLattice(grid);
+        const unsigned int row = lattice / grid.Length();
+        const unsigned int col = lattice % grid.Length();
+        const Grid::TrailMark mark = grid.mark();
+        for (unsigned int digit = 1; digit <= grid.Length(); digit++)
+        {
+            if (!grid(row, col, digit))
+                continue;
+            grid.place(lattice, digit);
+            if (searchNode(grid, depth + 1))
+            {
+                grid.release();
+                return true;
+            }
+            grid.undo(mark);
+        }
+        grid.release();
+        return false;
+    }
+
+    static bool solveGrid(Grid& grid, Searcher& searcher)
+    { return countGrid(grid, searcher, 1, nullptr) == 1; }
+
+    static unsigned long countGrid(Grid& grid, Searcher& searcher,
+        unsigned long limit, const SolutionCallback* onSolution)
+    {
+        grid.initializeMask();
+        if (!propagate(grid, grid.Length()))
+            return 0;
+        if (grid.isCompleted())
+        {
+            if (onSolution != nullptr)
+                (*onSolution)(grid.Lattices());
+            return 1;
+        }
+        const unsigned long found = searcher.count(grid, limit, onSolution);
+        if (grid.Stats() != nullptr)
+            grid.Stats()->search_nodes += searcher.Nodes();
+        return found;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,4 @@
+#ifndef SOLVER_H
+#define SOLVER_H
+#include "solver.cxx"
+#endif
\ No newline at end of file
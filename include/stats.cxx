@@ -0,0 +1,135 @@
+/*******************************************
+ * @title   Stats
+ * @brief   counters and phase timings of a
+ * solve, printed as JSON by --stats
+ * @author  Bin Qu
+ * @date    2026.10.17
+ * @copyright   You can edit and remodify
+ * this file.
+*******************************************/
+
+#include <cstdio>
+
+namespace sds
+{
+    /**
+     * What the rules did during one or more solves. Grid and
+     * FixedGrid only count into it when one is attached, so a
+     * solve without stats pays a null check per call.
+    */
+    struct SolveStats
+    {
+        /**
+         * @brief i-excluding and hidden subsets are counted
+         * per i up to this size length
+        */
+        static constexpr unsigned int MAX_IE = 128;
+
+        /* fill() calls, and those that placed at least one digit */
+        unsigned long fill_calls;
+        unsigned long fill_passes;
+        /* digits written by fill() */
+        unsigned long placements;
+        /* calls and candidates removed, indexed by i */
+        unsigned long excluding_calls[MAX_IE];
+        unsigned long excluding_eliminations[MAX_IE];
+        unsigned long hiding_calls[MAX_IE];
+        unsigned long hiding_eliminations[MAX_IE];
+        /* masks built from the clues */
+        unsigned long initialize_mask;
+        /* peer masks a placed digit was removed from */
+        unsigned long peer_updates;
+        /* nodes visited by whichever search ran */
+        unsigned long search_nodes;
+        /* phase durations */
+        double initialize_ms;
+        double solve_ms;
+        double output_ms;
+
+        SolveStats() { clear(); }
+
+        /**
+         * @brief set every counter and timing to zero
+        */
+        void clear();
+        /**
+         * @brief add another set of stats to this one
+        */
+        void merge(const SolveStats& other);
+    };
+
+    /**
+     * @brief print stats as one JSON object, leaving out
+     * the i levels that were never tried
+     * @param stats stats to print
+     * @param stream output stream
+    */
+    static void printStats(const SolveStats& stats, std::FILE* stream);
+
+    void SolveStats::clear()
+    {
+        fill_calls = fill_passes = placements = 0;
+        for (unsigned int ie = 0; ie < MAX_IE; ie++)
+        {
+            excluding_calls[ie] = excluding_eliminations[ie] = 0;
+            hiding_calls[ie] = hiding_eliminations[ie] = 0;
+        }
+        initialize_mask = peer_updates = 0;
+        search_nodes = 0;
+        initialize_ms = solve_ms = output_ms = 0;
+    }
+
+    void SolveStats::merge(const SolveStats& other)
+    {
+        fill_calls += other.fill_calls;
+        fill_passes += other.fill_passes;
+        placements += other.placements;
+        for (unsigned int ie = 0; ie < MAX_IE; ie++)
+        {
+            excluding_calls[ie] += other.excluding_calls[ie];
+            excluding_eliminations[ie] += other.excluding_eliminations[ie];
+            hiding_calls[ie] += other.hiding_calls[ie];
+            hiding_eliminations[ie] += other.hiding_eliminations[ie];
+        }
+        initialize_mask += other.initialize_mask;
+        peer_updates += other.peer_updates;
+        search_nodes += other.search_nodes;
+        initialize_ms += other.initialize_ms;
+        solve_ms += other.solve_ms;
+        output_ms += other.output_ms;
+    }
+
+    static void printStats(const SolveStats& stats, std::FILE* stream)
+    {
+        std::fprintf(stream, "{\"fill\": {\"calls\": %lu, \"passes\": %lu, "
+            "\"placements\": %lu}, ", stats.fill_calls, stats.fill_passes,
+            stats.placements);
+        const char* rules[2] = {"excluding", "hiding"};
+        const unsigned long* calls[2] =
+            {stats.excluding_calls, stats.hiding_calls};
+        const unsigned long* eliminations[2] =
+            {stats.excluding_eliminations, stats.hiding_eliminations};
+        for (unsigned int r = 0; r < 2; r++)
+        {
+            std::fprintf(stream, "\"%s\": {", rules[r]);
+            bool isFirst = true;
+            for (unsigned int ie = 0; ie < SolveStats::MAX_IE; ie++)
+            {
+                if (calls[r][ie] == 0)
+                    continue;
+                std::fprintf(stream, "%s\"%u\": {\"calls\": %lu, "
+                    "\"eliminations\": %lu}", isFirst ? "" : ", ", ie,
+                    calls[r][ie], eliminations[r][ie]);
+                isFirst = false;
+            }
+            std::fprintf(stream, "}, ");
+        }
+        std::fprintf(stream, "\"mask\": {\"initialize\": %lu, "
+            "\"peer_updates\": %lu}, "
+            "\"search_nodes\": %lu, \"phases_ms\": {\"initialize\": %.3f, "
+            "\"solve\": %.3f, \"output\": %.3f}}\r\n",
+            stats.initialize_mask, stats.peer_updates,
+            stats.search_nodes, stats.initialize_ms, stats.solve_ms,
+            stats.output_ms);
+    }
+}
\ No newline at end of file
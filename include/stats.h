@@ -0,0 +1,4 @@
+#ifndef STATS_H
+#define STATS_H
+#include "stats.cxx"
+#endif
\ No newline at end of file
@@ -0,0 +1,406 @@
+/*******************************************
+ * @title   Store
+ * @brief   persistent memory-mapped hash table
+ * of solutions keyed by puzzle hash
+ * @author  Bin Qu
+ * @date    2026.10.17
+ * @copyright   You can edit and remodify
+ * this file.
+*******************************************/
+
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>      // open
+#include <sys/file.h>   // flock
+#include <sys/mman.h>   // mmap
+#include <sys/stat.h>   // fstat
+#include <unistd.h>     // close
+
+namespace sds
+{
+    /**
+     * A file of solutions shared by runs and processes. It is
+     * an open-addressing hash table of fixed-size slots, each a
+     * puzzle hash, a checksum, a state word and the solution
+     * packed in as few bits per digit as the size needs. The
+     * file is created by the first insert, for the size of that
+     * puzzle, and never grows; puzzles of other sizes, and those
+     * that find no free slot near their hash, are not stored.
+     *
+     * Readers probe the mapping without locks. Writers take an
+     * flock on the file, so only one process writes at a time,
+     * and only ever fill free or damaged slots, publishing the
+     * state word last. A slot torn by a crash fails its checksum
+     * and is treated as damaged; a hit is also checked against
+     * the clues, so a hash collision cannot return a wrong grid.
+    */
+    class SolutionStore
+    {
+    public:
+        /**
+         * @brief the file is sized to about this many bytes,
+         * sparse until slots are written
+        */
+        static constexpr std::uint64_t FILE_BYTES = 64ULL << 20;
+        /**
+         * @brief slots probed from the hash before giving up
+        */
+        static constexpr unsigned int MAX_PROBE = 32;
+
+    private:
+        struct Header
+        {
+            char magic[8];
+            std::uint32_t version;
+            std::uint32_t length;
+            std::uint32_t slotSize;
+            std::uint32_t bits;
+            /* a power of 2 */
+            std::uint64_t slots;
+            /* filled slots, updated by the writer */
+            std::uint64_t count;
+        };
+        struct Slot
+        {
+            std::uint64_t hash;
+            std::uint32_t checksum;
+            /* slot_empty or slot_full, written last */
+            std::uint32_t state;
+            /* followed by the packed solution */
+        };
+        enum SlotState {slot_empty, slot_full};
+        static constexpr std::uint32_t VERSION = 1;
+        static constexpr std::size_t HEADER_SIZE = 64;
+
+        std::string path;
+        int fd = -1;
+        /* the file could only be opened for reading */
+        bool isReadOnly = false;
+        /* the mapping, nullptr until the file exists */
+        std::atomic<char*> base;
+        std::size_t size = 0;
+        /* serialize mapping and writing inside the process */
+        std::mutex lock;
+        std::atomic<unsigned long> hits;
+        std::atomic<unsigned long> added;
+
+        /**
+         * @brief map the file if it exists and is complete
+         * @param length create it for this size if it does not
+         * exist, 0 to only open
+         * @return is the file mapped?
+        */
+        bool map(unsigned int length);
+        const Header& header() const { return *(const Header*)base.load(); }
+        Slot* slot(std::uint64_t index) const;
+        /**
+         * @brief checksum of a slot's hash and packed solution
+        */
+        std::uint32_t checksum(const Slot* s) const;
+        static std::uint64_t hashPuzzle(const char* puzzle,
+            unsigned int length);
+        /**
+         * @brief is solution a complete grid that keeps
+         * every clue of puzzle?
+        */
+        static bool isSolutionOf(const char* puzzle, const char* solution,
+            unsigned int length);
+        /**
+         * @brief unpack the solution of a slot into a buffer
+         * of the calling thread
+         * @return the solution, nullptr if it is not one of
+         * puzzle
+        */
+        const char* solutionOf(const Slot* s, const char* puzzle) const;
+
+    public:
+        /**
+         * @brief look up the solution of a puzzle
+         * @param puzzle row-major digits, 0 for empty
+         * @param length grid size length
+         * @param solution receives the solution, untouched
+         * on a miss
+         * @return is it stored?
+        */
+        bool find(const char* puzzle, unsigned int length, char* solution);
+        /**
+         * @brief store the solution of a puzzle, creating the
+         * file on first use
+         * @return is it stored, or was it already?
+        */
+        bool insert(const char* puzzle, const char* solution,
+            unsigned int length);
+        unsigned long Hits() const { return hits.load(); }
+        unsigned long Added() const { return added.load(); }
+        /**
+         * @brief constructor, maps the file if it exists
+         * @param path file path
+        */
+        SolutionStore(const std::string& path);
+        SolutionStore(const SolutionStore&) = delete;
+        SolutionStore& operator=(const SolutionStore&) = delete;
+        /**
+         * @brief deconstructor that unmaps the file
+        */
+        ~SolutionStore();
+    };
+
+    SolutionStore::SolutionStore(const std::string& path)
+        : path(path), base(nullptr), hits(0), added(0)
+    { map(0); }
+
+    SolutionStore::~SolutionStore()
+    {
+        if (base.load() != nullptr)
+            ::munmap(base.load(), size);
+        if (fd >= 0)
+            ::close(fd);
+    }
+
+    bool SolutionStore::map(unsigned int length)
+    {
+        if (base.load(std::memory_order_acquire) != nullptr)
+            return true;
+        if (fd < 0)
+            fd = ::open(path.c_str(), length == 0 ? O_RDWR : O_RDWR | O_CREAT,
+                0644);
+        if (fd < 0 && length == 0 && errno == EACCES)
+        {
+            fd = ::open(path.c_str(), O_RDONLY);
+            isReadOnly = fd >= 0;
+        }
+        if (fd < 0)
+            return false;
+
+        struct stat info;
+        if (::fstat(fd, &info) != 0)
+            return false;
+        if (info.st_size == 0 && length != 0)
+        {
+            /* the first writer lays out the file */
+            ::flock(fd, LOCK_EX);
+            if (::fstat(fd, &info) == 0 && info.st_size == 0)
+            {
+                unsigned int bits = 1;
+                while ((1U << bits) <= length)
+                    bits++;
+                const std::uint32_t packed = (length * length * bits + 7) / 8;
+                const std::uint32_t slotSize =
+                    (sizeof(Slot) + packed + 7) / 8 * 8;
+                std::uint64_t slots = 1;
+                while (slots * 2 * slotSize <= FILE_BYTES)
+                    slots *= 2;
+                Header h;
+                std::memset(&h, 0, sizeof(h));
+                h.version = VERSION;
+                h.length = length;
+                h.slotSize = slotSize;
+                h.bits = bits;
+                h.slots = slots;
+                if (::ftruncate(fd, HEADER_SIZE + slots * slotSize) == 0)
+                {
+                    /* the magic goes in last, a file without it is
+                    still being laid out */
+                    ::pwrite(fd, &h, sizeof(h), 0);
+                    ::pwrite(fd, "SDSSTORE", 8, 0);
+                }
+            }
+            ::flock(fd, LOCK_UN);
+            if (::fstat(fd, &info) != 0)
+                return false;
+        }
+
+        Header h;
+        if ((std::size_t)info.st_size < HEADER_SIZE ||
+            ::pread(fd, &h, sizeof(h), 0) != sizeof(h) ||
+            std::memcmp(h.magic, "SDSSTORE", 8) != 0 ||
+            h.version != VERSION || h.slots == 0 ||
+            (h.slots & (h.slots - 1)) != 0 ||
+            (std::uint64_t)info.st_size < HEADER_SIZE + h.slots * h.slotSize)
+            return false;
+        void* addr = ::mmap(nullptr, info.st_size, isReadOnly ? PROT_READ :
+            PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (addr == MAP_FAILED)
+            return false;
+        size = info.st_size;
+        base.store((char*)addr, std::memory_order_release);
+        return true;
+    }
+
+    SolutionStore::Slot* SolutionStore::slot(std::uint64_t index) const
+    {
+        return (Slot*)(base.load(std::memory_order_relaxed) + HEADER_SIZE +
+            index * header().slotSize);
+    }
+
+    std::uint32_t SolutionStore::checksum(const Slot* s) const
+    {
+        const Header& h = header();
+        const unsigned char* data = (const unsigned char*)(s + 1);
+        const std::size_t packed = (h.length * h.length * h.bits + 7) / 8;
+        std::uint32_t sum = 2166136261U;
+        for (unsigned int k = 0; k < 8; k++)
+        {
+            sum ^= (unsigned char)(s->hash >> (8 * k));
+            sum *= 16777619U;
+        }
+        for (std::size_t k = 0; k < packed; k++)
+        {
+            sum ^= data[k];
+            sum *= 16777619U;
+        }
+        return sum;
+    }
+
+    std::uint64_t SolutionStore::hashPuzzle(const char* puzzle,
+        unsigned int length)
+    {
+        std::uint64_t hash = 14695981039346656037ULL;
+        hash ^= length;
+        hash *= 1099511628211ULL;
+        for (unsigned int i = 0; i < length * length; i++)
+        {
+            hash ^= (unsigned char)puzzle[i];
+            hash *= 1099511628211ULL;
+        }
+        return hash;
+    }
+
+    bool SolutionStore::isSolutionOf(const char* puzzle, const char* solution,
+        unsigned int length)
+    {
+        unsigned int block = 1;
+        while (block * block < length)
+            block++;
+        static thread_local std::vector<unsigned char> seen;
+        seen.assign(3 * length * length, 0);
+        for (unsigned int i = 0; i < length * length; i++)
+        {
+            const int digit = solution[i];
+            if (digit < 1 || digit > (int)length ||
+                (puzzle[i] != 0 && puzzle[i] != digit))
+                return false;
+            const unsigned int row = i / length;
+            const unsigned int col = i % length;
+            const unsigned int box = row / block * block + col / block;
+            unsigned char& inRow = seen[row * length + digit - 1];
+            unsigned char& inCol = seen[(length + col) * length + digit - 1];
+            unsigned char& inBox = seen[(2 * length + box) * length + digit - 1];
+            if (inRow || inCol || inBox)
+                return false;
+            inRow = inCol = inBox = 1;
+        }
+        return true;
+    }
+
+    const char* SolutionStore::solutionOf(const Slot* s,
+        const char* puzzle) const
+    {
+        const Header& h = header();
+        const unsigned int length = h.length;
+        const std::size_t packed = (length * length * h.bits + 7) / 8;
+        static thread_local std::vector<char> unpacked;
+        unpacked.resize(length * length);
+        /* unpack bits LSB first */
+        const unsigned char* data = (const unsigned char*)(s + 1);
+        const unsigned int mask = (1U << h.bits) - 1;
+        for (unsigned int i = 0, bit = 0; i < length * length;
+            i++, bit += h.bits)
+        {
+            const unsigned int word = data[bit / 8] |
+                (bit / 8 + 1 < packed ? data[bit / 8 + 1] << 8 : 0);
+            unpacked[i] = (word >> (bit % 8)) & mask;
+        }
+        return isSolutionOf(puzzle, unpacked.data(), length) ?
+            unpacked.data() : nullptr;
+    }
+
+    bool SolutionStore::find(const char* puzzle, unsigned int length,
+        char* solution)
+    {
+        if (base.load(std::memory_order_acquire) == nullptr)
+        {
+            /* another process may have created it since */
+            std::lock_guard<std::mutex> guard(lock);
+            if (!map(0))
+                return false;
+        }
+        const Header& h = header();
+        if (h.length != length)
+            return false;
+        const std::uint64_t hash = hashPuzzle(puzzle, length);
+        for (unsigned int k = 0; k < MAX_PROBE; k++)
+        {
+            const Slot* s = slot((hash + k) & (h.slots - 1));
+            const std::uint32_t state =
+                __atomic_load_n(&s->state, __ATOMIC_ACQUIRE);
+            if (state == slot_empty)
+                return false;
+            if (s->hash != hash || s->checksum != checksum(s))
+                continue;
+            const char* stored = solutionOf(s, puzzle);
+            if (stored == nullptr)
+                continue;
+            std::memcpy(solution, stored, length * length);
+            hits.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+        return false;
+    }
+
+    bool SolutionStore::insert(const char* puzzle, const char* solution,
+        unsigned int length)
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        if (!map(length) || isReadOnly || header().length != length)
+            return false;
+        const Header& h = header();
+        const std::uint64_t hash = hashPuzzle(puzzle, length);
+        const std::size_t packed = (length * length * h.bits + 7) / 8;
+        bool isStored = false;
+        ::flock(fd, LOCK_EX);
+        for (unsigned int k = 0; k < MAX_PROBE && !isStored; k++)
+        {
+            Slot* s = slot((hash + k) & (h.slots - 1));
+            const bool isValid = s->state == slot_full &&
+                s->checksum == checksum(s);
+            /* another puzzle with the same hash keeps its slot */
+            if (isValid && s->hash == hash && solutionOf(s, puzzle) != nullptr)
+            {
+                isStored = true;
+                break;
+            }
+            if (isValid)
+                continue;
+            /* a free slot, or one damaged by a crash; readers that
+            see it half written fail the checksum */
+            unsigned char* data = (unsigned char*)(s + 1);
+            std::memset(data, 0, packed);
+            for (unsigned int i = 0, bit = 0; i < length * length;
+                i++, bit += h.bits)
+            {
+                const unsigned int word = (unsigned int)solution[i] << (bit % 8);
+                data[bit / 8] |= word & 0xFF;
+                if (bit / 8 + 1 < packed)
+                    data[bit / 8 + 1] |= word >> 8;
+            }
+            s->hash = hash;
+            s->checksum = checksum(s);
+            __atomic_store_n(&s->state, (std::uint32_t)slot_full,
+                __ATOMIC_RELEASE);
+            __atomic_fetch_add(&((Header*)base.load())->count, 1,
+                __ATOMIC_RELAXED);
+            added.fetch_add(1, std::memory_order_relaxed);
+            isStored = true;
+        }
+        ::flock(fd, LOCK_UN);
+        return isStored;
+    }
+}
\ No newline at end of file
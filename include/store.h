@@ -0,0 +1,4 @@
+#ifndef STORE_H
+#define STORE_H
+#include "store.cxx"
+#endif
\ No newline at end of file
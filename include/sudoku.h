@@ -0,0 +1,104 @@
+/*******************************************
+ * @title   Sudoku Library
+ * @brief   plain C interface of libsudoku,
+ * one context per thread
+ * @author  Bin Qu
+ * @date    2026.10.17
+ * @copyright   You can edit and remodify
+ * this file.
+*******************************************/
+
+#ifndef SUDOKU_H
+#define SUDOKU_H
+
+#include <stddef.h>
+
+#if defined(_WIN32)
+#define SDS_API __declspec(dllexport)
+#elif defined(__GNUC__)
+#define SDS_API __attribute__((visibility("default")))
+#else
+#define SDS_API
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief what a solve call returns
+*/
+enum sds_status
+{
+    SDS_SOLVED = 0,
+    /* the clues contradict or admit no solution */
+    SDS_UNSOLVABLE = 1,
+    /* not a puzzle, or not a supported size */
+    SDS_INVALID = 2,
+    /* out is too small, nothing is written */
+    SDS_BUFFER_TOO_SMALL = 3,
+    SDS_NO_MEMORY = 4
+};
+
+/**
+ * @brief engines a context can solve with
+*/
+enum sds_engine
+{
+    SDS_ENGINE_LOGIC = 0,
+    SDS_ENGINE_DLX = 1
+};
+
+/**
+ * @brief solver state and buffers, opaque
+*/
+typedef struct sds_context sds_context;
+
+/**
+ * @brief create a context, with the logic engine
+ * @return nullptr if out of memory
+*/
+SDS_API sds_context* sds_context_new(void);
+
+/**
+ * @brief free a context, nullptr is ignored
+*/
+SDS_API void sds_context_free(sds_context* ctx);
+
+/**
+ * @brief choose the engine of later solves
+ * @param engine one of sds_engine
+*/
+SDS_API void sds_context_set_engine(sds_context* ctx, int engine);
+
+/**
+ * @brief solve a puzzle given as text: a one-line puzzle
+ * (dots, digits, hexadecimal or letters, as --batch reads)
+ * or a csv grid. The solution is written in the same
+ * layout, without a trailing line end, and NUL-terminated:
+ * a one-line puzzle needs strlen(in) + 1 bytes.
+ * @param in NUL-terminated puzzle text
+ * @param out output buffer
+ * @param out_size size of out in bytes
+ * @return one of sds_status
+*/
+SDS_API int sds_solve(sds_context* ctx, const char* in, char* out,
+    size_t out_size);
+
+/**
+ * @brief solve a puzzle given as row-major digits,
+ * 0 for empty
+ * @param in length * length digits
+ * @param out length * length bytes receiving the
+ * solution, may be in
+ * @param length grid size length, e.g. 9
+ * @return one of sds_status
+*/
+SDS_API int sds_solve_digits(sds_context* ctx, const char* in, char* out,
+    unsigned int length);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
\ No newline at end of file
@@ -0,0 +1,272 @@
+/*******************************************
+ * @title   Trace
+ * @brief   leveled trace events recorded into
+ * a lock-free ring and printed off the hot path
+ * @author  Bin Qu
+ * @date    2026.10.17
+ * @copyright   You can edit and remodify
+ * this file.
+*******************************************/
+
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+
+/**
+ * @brief the most verbose level compiled in, 0 compiles
+ * every SDS_TRACE away
+*/
+#ifndef SDS_TRACE_LEVEL
+#define SDS_TRACE_LEVEL 3
+#endif
+
+/**
+ * @brief record a trace event if level is compiled in and
+ * enabled. fmt must be a string literal whose conversions
+ * take long arguments (%ld) after an optional leading %s.
+ * Arguments are not evaluated when the level is off.
+*/
+#if SDS_TRACE_LEVEL > 0
+#define SDS_TRACE(level, ...) \
+    do { if ((level) <= SDS_TRACE_LEVEL && sds::isTracing(level)) \
+        sds::traceEvent((level), __VA_ARGS__); } while (0)
+#else
+#define SDS_TRACE(level, ...) do { } while (0)
+#endif
+
+namespace sds
+{
+    /**
+     * Trace levels, each one includes those before it
+    */
+    enum TraceLevel {trace_off, trace_error, trace_info, trace_debug};
+
+    /**
+     * A recorded event, formatted only when flushed
+    */
+    struct TraceEvent
+    {
+        int level;
+        const char* fmt;
+        long args[4];
+        /* copy of the %s argument, if fmt starts with one */
+        char text[64];
+        bool hasText;
+    };
+
+    /**
+     * Bounded multi-producer ring of trace events. Producers
+     * claim a slot with one CAS and never wait: when the ring
+     * is full the event is dropped and counted. traceFlush()
+     * drains it from a single thread.
+    */
+    class TraceRing
+    {
+    public:
+        /**
+         * @brief the number of slots, a power of 2
+        */
+        static constexpr unsigned long CAPACITY = 1 << 14;
+
+    private:
+        struct Slot
+        {
+            /* == position when free for it, position + 1 once written */
+            std::atomic<unsigned long> sequence;
+            TraceEvent event;
+        };
+        Slot slots[CAPACITY];
+        std::atomic<unsigned long> head;
+        /* only the flushing thread moves the tail */
+        unsigned long tail;
+        std::atomic<unsigned long> dropped;
+
+    public:
+        /**
+         * @brief claim a slot for an event
+         * @return the slot to fill and pass to publish(),
+         * nullptr if the ring is full
+        */
+        TraceEvent* claim(unsigned long& position);
+        /**
+         * @brief make a filled slot visible to the flusher
+        */
+        void publish(unsigned long position);
+        /**
+         * @brief print and release every published event
+         * @param stream output stream
+         * @return the number of events printed
+        */
+        unsigned long drain(std::FILE* stream);
+        TraceRing();
+    };
+
+    /**
+     * @brief current level, set by --quiet / --trace
+    */
+    static std::atomic<int> traceLevel(trace_info);
+    /**
+     * @brief the process wide ring
+    */
+    static TraceRing traceRing;
+
+    /**
+     * @brief is an event of this level recorded?
+    */
+    static inline bool isTracing(int level)
+    { return level <= traceLevel.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief set the current level
+    */
+    static inline void setTraceLevel(TraceLevel level)
+    { traceLevel.store(level, std::memory_order_relaxed); }
+
+    /**
+     * @brief parse a level name
+     * @param name "off", "error", "info" or "debug"
+     * @param level receives the level
+     * @return false if the name is unknown
+    */
+    static bool parseTraceLevel(const char* name, TraceLevel& level);
+
+    /**
+     * @brief record an event with numeric arguments
+    */
+    static void traceEvent(int level, const char* fmt, long a0 = 0,
+        long a1 = 0, long a2 = 0, long a3 = 0);
+    /**
+     * @brief record an event whose format starts with %s,
+     * text is copied (and cut at 63 chars)
+    */
+    static void traceEvent(int level, const char* fmt, const char* text,
+        long a0 = 0, long a1 = 0, long a2 = 0);
+
+    /**
+     * @brief print every recorded event, and how many
+     * were dropped since the last flush
+     * @param stream output stream, stderr by default
+    */
+    static void traceFlush(std::FILE* stream = stderr);
+
+    TraceRing::TraceRing() : head(0), tail(0), dropped(0)
+    {
+        for (unsigned long i = 0; i < CAPACITY; i++)
+            slots[i].sequence.store(i, std::memory_order_relaxed);
+    }
+
+    TraceEvent* TraceRing::claim(unsigned long& position)
+    {
+        position = head.load(std::memory_order_relaxed);
+        while (true)
+        {
+            Slot& slot = slots[position & (CAPACITY - 1)];
+            const long diff = (long)(slot.sequence.load(
+                std::memory_order_acquire) - position);
+            if (diff == 0)
+            {
+                if (head.compare_exchange_weak(position, position + 1,
+                    std::memory_order_relaxed))
+                    return &slot.event;
+            }
+            else if (diff < 0)
+            {
+                /* a lap ahead of the flusher */
+                dropped.fetch_add(1, std::memory_order_relaxed);
+                return nullptr;
+            }
+            else
+                position = head.load(std::memory_order_relaxed);
+        }
+    }
+
+    void TraceRing::publish(unsigned long position)
+    {
+        slots[position & (CAPACITY - 1)].sequence.store(position + 1,
+            std::memory_order_release);
+    }
+
+    unsigned long TraceRing::drain(std::FILE* stream)
+    {
+        unsigned long count = 0;
+        while (true)
+        {
+            Slot& slot = slots[tail & (CAPACITY - 1)];
+            if (slot.sequence.load(std::memory_order_acquire) != tail + 1)
+                break;
+            const TraceEvent& e = slot.event;
+            if (e.hasText)
+                std::fprintf(stream, e.fmt, e.text, e.args[0], e.args[1],
+                    e.args[2]);
+            else
+                std::fprintf(stream, e.fmt, e.args[0], e.args[1], e.args[2],
+                    e.args[3]);
+            slot.sequence.store(tail + CAPACITY, std::memory_order_release);
+            tail++;
+            count++;
+        }
+        const unsigned long lost = dropped.exchange(0,
+            std::memory_order_relaxed);
+        if (lost != 0)
+            std::fprintf(stream, "trace: %lu events dropped\r\n", lost);
+        return count;
+    }
+
+    static bool parseTraceLevel(const char* name, TraceLevel& level)
+    {
+        static const char* names[] = {"off", "error", "info", "debug"};
+        for (int i = trace_off; i <= trace_debug; i++)
+            if (std::strcmp(name, names[i]) == 0)
+            {
+                level = (TraceLevel)i;
+                return true;
+            }
+        return false;
+    }
+
+    static void traceEvent(int level, const char* fmt, long a0, long a1,
+        long a2, long a3)
+    {
+        unsigned long position;
+        TraceEvent* e = traceRing.claim(position);
+        if (e == nullptr)
+            return;
+        e->level = level;
+        e->fmt = fmt;
+        e->args[0] = a0;
+        e->args[1] = a1;
+        e->args[2] = a2;
+        e->args[3] = a3;
+        e->hasText = false;
+        traceRing.publish(position);
+    }
+
+    static void traceEvent(int level, const char* fmt, const char* text,
+        long a0, long a1, long a2)
+    {
+        unsigned long position;
+        TraceEvent* e = traceRing.claim(position);
+        if (e == nullptr)
+            return;
+        e->level = level;
+        e->fmt = fmt;
+        std::strncpy(e->text, text, sizeof(e->text) - 1);
+        e->text[sizeof(e->text) - 1] = '\0';
+        e->args[0] = a0;
+        e->args[1] = a1;
+        e->args[2] = a2;
+        e->hasText = true;
+        traceRing.publish(position);
+    }
+
+    static void traceFlush(std::FILE* stream)
+    {
+        /* one flusher at a time, producers never take it */
+        static std::atomic_flag isFlushing = ATOMIC_FLAG_INIT;
+        if (isFlushing.test_and_set(std::memory_order_acquire))
+            return;
+        if (traceRing.drain(stream) != 0)
+            std::fflush(stream);
+        isFlushing.clear(std::memory_order_release);
+    }
+}
\ No newline at end of file
@@ -0,0 +1,4 @@
+#ifndef TRACE_H
+#define TRACE_H
+#include "trace.cxx"
+#endif
\ No newline at end of file
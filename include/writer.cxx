@@ -0,0 +1,270 @@
+/*******************************************
+ * @title   Writer
+ * @brief   encode solutions as fixed-size
+ * records and write them in big chunks
+ * @author  Bin Qu
+ * @date    2026.10.17
+ * @copyright   You can edit and remodify
+ * this file.
+*******************************************/
+
+#include "PuzzleReader.h"
+
+#include <atomic>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+#include <fcntl.h>      // open
+#include <unistd.h>     // pwrite, close
+
+namespace sds
+{
+    /**
+     * Encoding of the solutions of a batch
+    */
+    enum Encoding
+    {
+        /* the layout of each puzzle, records vary in size */
+        enc_input,
+        /* comma separated rows, every value zero-padded to
+        the width of the grid length, then a blank line */
+        enc_csv,
+        /* one line per puzzle in the fmt_line alphabet */
+        enc_line,
+        /* one byte per lattice, the digit itself */
+        enc_binary
+    };
+
+    /**
+     * @brief parse an encoding name
+     * @param name "input", "csv", "line" or "binary"
+     * @param encoding receives the encoding
+     * @return false if the name is unknown
+    */
+    static bool parseEncoding(const char* name, Encoding& encoding);
+
+    /**
+     * @brief append a number in decimal, without printf
+    */
+    static inline void appendDecimal(unsigned long value, std::string& out);
+
+    /**
+     * @brief the size of a record of a grid size length,
+     * 0 for enc_input
+    */
+    static std::size_t recordBytes(Encoding encoding, unsigned int length);
+
+    /**
+     * @brief encode a grid as one record
+     * @param digits row-major digits, 0 for empty
+     * @param length grid size length
+     * @param encoding enc_csv, enc_line or enc_binary
+     * @param out receives exactly recordBytes() bytes
+    */
+    static void encodeRecord(const char* digits, unsigned int length,
+        Encoding encoding, char* out);
+
+    /**
+     * @brief append a grid as one record to an output buffer
+    */
+    static void appendRecord(const char* digits, unsigned int length,
+        Encoding encoding, std::string& out);
+
+    /**
+     * Output file of fixed-size records. Record k lives at
+     * k * RecordBytes(), so threads write whole runs of
+     * records straight to their place, in any order and
+     * without a lock.
+    */
+    class RecordFile
+    {
+    private:
+        int fd;
+        Encoding encoding;
+        /**
+         * @brief grid size length of every record, 0 until
+         * the first puzzle is read
+        */
+        unsigned int length = 0;
+        std::size_t bytes = 0;
+        /**
+         * @brief a write failed, reported once
+        */
+        std::atomic<bool> isFailed;
+
+    public:
+        bool isOpen() { return fd >= 0; }
+        /**
+         * @brief judge if every write so far succeeded
+        */
+        bool isGood() { return isOpen() && !isFailed.load(); }
+        unsigned int Length() { return length; }
+        std::size_t RecordBytes() { return bytes; }
+        /**
+         * @brief fix the grid size of the records, once,
+         * before any write
+        */
+        void setLength(unsigned int length);
+        /**
+         * @brief write whole records
+         * @param first index of the first record
+         * @param data records, a multiple of RecordBytes()
+         * @param size the number of bytes of data
+         * @return false on error
+        */
+        bool write(unsigned long first, const char* data, std::size_t size);
+        /**
+         * @brief constructor, truncate or create a file
+         * @param path output file path
+         * @param encoding enc_csv, enc_line or enc_binary
+        */
+        RecordFile(const char* path, Encoding encoding);
+        ~RecordFile();
+    };
+
+    static bool parseEncoding(const char* name, Encoding& encoding)
+    {
+        static const char* names[] = {"input", "csv", "line", "binary"};
+        for (int i = enc_input; i <= enc_binary; i++)
+            if (std::strcmp(name, names[i]) == 0)
+            {
+                encoding = (Encoding)i;
+                return true;
+            }
+        return false;
+    }
+
+    static inline void appendDecimal(unsigned long value, std::string& out)
+    {
+        char tmpStr[24];
+        char* p = tmpStr + sizeof(tmpStr);
+        do
+        {
+            *--p = (char)('0' + value % 10);
+            value /= 10;
+        } while (value != 0);
+        out.append(p, tmpStr + sizeof(tmpStr) - p);
+    }
+
+    /**
+     * @brief the number of decimal digits of a grid length
+    */
+    static unsigned int decimalWidth(unsigned int length)
+    {
+        unsigned int width = 1;
+        for (; length >= 10; length /= 10)
+            width++;
+        return width;
+    }
+
+    static std::size_t recordBytes(Encoding encoding, unsigned int length)
+    {
+        const std::size_t sizegrid = length * length;
+        switch (encoding)
+        {
+        case enc_csv:
+            /* every row: length values, length - 1 commas and
+            "\r\n", then a blank line */
+            return length * (length * (decimalWidth(length) + 1) + 1) + 2;
+        case enc_line:
+            return sizegrid + 2;
+        case enc_binary:
+            return sizegrid;
+        default:
+            return 0;
+        }
+    }
+
+    static void encodeRecord(const char* digits, unsigned int length,
+        Encoding encoding, char* out)
+    {
+        const unsigned int sizegrid = length * length;
+        switch (encoding)
+        {
+        case enc_csv:
+        {
+            const unsigned int width = decimalWidth(length);
+            for (unsigned int i = 0; i < sizegrid; i++)
+            {
+                unsigned int value = (unsigned char)digits[i];
+                for (unsigned int k = width; k-- > 0; value /= 10)
+                    out[k] = (char)('0' + value % 10);
+                out += width;
+                if (i % length == length - 1)
+                {
+                    *out++ = '\r';
+                    *out++ = '\n';
+                }
+                else
+                    *out++ = ',';
+            }
+            *out++ = '\r';
+            *out++ = '\n';
+            break;
+        }
+        case enc_line:
+            for (unsigned int i = 0; i < sizegrid; i++)
+                out[i] = lineSymbol(digits[i], PuzzleFormat::fmt_line);
+            out[sizegrid] = '\r';
+            out[sizegrid + 1] = '\n';
+            break;
+        case enc_binary:
+            std::memcpy(out, digits, sizegrid);
+            break;
+        default:
+            break;
+        }
+    }
+
+    static void appendRecord(const char* digits, unsigned int length,
+        Encoding encoding, std::string& out)
+    {
+        const std::size_t size = out.size();
+        out.resize(size + recordBytes(encoding, length));
+        encodeRecord(digits, length, encoding, &out[size]);
+    }
+
+    RecordFile::RecordFile(const char* path, Encoding encoding)
+        : encoding(encoding), isFailed(false)
+    {
+        fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0)
+            std::perror(path);
+    }
+
+    RecordFile::~RecordFile()
+    {
+        if (fd >= 0)
+            close(fd);
+    }
+
+    void RecordFile::setLength(unsigned int length)
+    {
+        this->length = length;
+        bytes = recordBytes(encoding, length);
+    }
+
+    bool RecordFile::write(unsigned long first, const char* data,
+        std::size_t size)
+    {
+        off_t offset = (off_t)first * bytes;
+        while (size != 0)
+        {
+            const ssize_t n = pwrite(fd, data, size, offset);
+            if (n < 0 && errno == EINTR)
+                continue;
+            if (n <= 0)
+            {
+                if (!isFailed.exchange(true))
+                    std::perror("pwrite");
+                return false;
+            }
+            data += n;
+            size -= n;
+            offset += n;
+        }
+        return true;
+    }
+}
\ No newline at end of file
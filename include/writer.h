@@ -0,0 +1,4 @@
+#ifndef WRITER_H
+#define WRITER_H
+#include "writer.cxx"
+#endif
\ No newline at end of file
@@ -0,0 +1,121 @@
+/*******************************************
+ * @title   Sudoku Solver Benchmark
+ * @brief   time the engines over the bundled
+ * corpora, or over the given puzzle files.
+ * @author  Bin Qu
+ * @date    2026.10.17
+ * @copyright   You can edit and remodify
+ * this project.
+*******************************************/
+
+#include "benchmark.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <getopt.h>
+#include <string>
+#include <vector>
+
+static struct option bench_options[] =
+{
+    /*  option_name, argument, flag, short_option_name*/
+    {"help",    no_argument,        0,  'h'},
+    {"engine",  required_argument,  0,  'e'},
+    {"passes",  required_argument,  0,  'p'},
+    {"format",  required_argument,  0,  'o'},
+    {0,         0,                  0,   0}
+};
+
+static const char* BENCH_HELP =
+"\
+Usage: benchmark(.exe) [options] [corpus...]\r\n\
+Solve every corpus on one thread and print one result per corpus\r\n\
+and engine. Without corpora the bundled ones in bin/bench are used.\r\n\
+Options:\r\n\
+  --help(-h)              Display this information.\r\n\
+  --engine(-e) <name>     \"logic\", \"dlx\" or \"all\" (default).\r\n\
+  --passes(-p) <n>        Timed passes over each corpus (default 3).\r\n\
+  --format(-o) <fmt>      \"json\" (default, one object per line) or \"csv\".\r\n\
+";
+
+static const char* BENCH_CORPORA[] =
+{
+    "bin/bench/easy.txt",
+    "bin/bench/hard.txt",
+    "bin/bench/17clue.txt",
+    "bin/bench/16x16.csv",
+    "bin/bench/25x25.csv"
+};
+
+int main(int argc, char** argv)
+{
+    const char* engine = "all";
+    const char* format = "json";
+    unsigned int passes = 3;
+    int c;
+    int option_index;
+    while (true)
+    {
+        option_index = 0;
+        c = getopt_long(argc, argv, "he:p:o:", bench_options, &option_index);
+        if (c == -1)
+            break;
+        switch (c)
+        {
+        case 'h':
+            std::printf("%s", BENCH_HELP);
+            exit(0);
+        case 'e':
+            engine = optarg;
+            break;
+        case 'p':
+            passes = std::atoi(optarg);
+            break;
+        case 'o':
+            format = optarg;
+            break;
+        default:
+            std::fprintf(stderr, "%s", BENCH_HELP);
+            exit(-1);
+        }
+    }
+
+    std::vector<bool> engines;
+    if (std::strcmp(engine, "logic") == 0 || std::strcmp(engine, "all") == 0)
+        engines.push_back(false);
+    if (std::strcmp(engine, "dlx") == 0 || std::strcmp(engine, "all") == 0)
+        engines.push_back(true);
+    const bool isCSV = std::strcmp(format, "csv") == 0;
+    if (engines.empty() || passes == 0 ||
+        (!isCSV && std::strcmp(format, "json") != 0))
+    {
+        std::fprintf(stderr, "%s", BENCH_HELP);
+        exit(-1);
+    }
+
+    std::vector<std::string> corpora(argv + optind, argv + argc);
+    if (corpora.empty())
+        corpora.assign(std::begin(BENCH_CORPORA), std::end(BENCH_CORPORA));
+
+    int returnCode = 0;
+    bool isHeader = true;
+    for (const std::string& corpus : corpora)
+        for (bool isDLX : engines)
+        {
+            sds::BenchResult result;
+            if (!sds::runBenchmark(corpus, isDLX, passes, result))
+            {
+                std::fprintf(stderr, "Fail to load the corpus %s\r\n",
+                    corpus.c_str());
+                returnCode = -1;
+                break;
+            }
+            sds::printBenchResult(result, isCSV, isHeader);
+            std::fflush(stdout);
+            isHeader = false;
+            if (result.solved != result.puzzles)
+                returnCode = -1;
+        }
+    exit(returnCode);
+}
\ No newline at end of file
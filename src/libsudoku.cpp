@@ -0,0 +1,71 @@
+/*******************************************
+ * @title   libsudoku
+ * @brief   the solver as a shared library
+ * with a plain C interface, see sudoku.h
+ * @author  Bin Qu
+ * @date    2026.10.17
+ * @copyright   You can edit and remodify
+ * this project.
+*******************************************/
+
+#include "library.h"
+#include "sudoku.h"
+
+#include <new>
+
+struct sds_context
+{
+    sds::SolverContext solver;
+};
+
+sds_context* sds_context_new(void)
+{
+    try
+    {
+        return new sds_context;
+    }
+    catch (const std::bad_alloc&)
+    {
+        return nullptr;
+    }
+}
+
+void sds_context_free(sds_context* ctx)
+{
+    delete ctx;
+}
+
+void sds_context_set_engine(sds_context* ctx, int engine)
+{
+    ctx->solver.setDLX(engine == SDS_ENGINE_DLX);
+}
+
+int sds_solve(sds_context* ctx, const char* in, char* out, size_t out_size)
+{
+    if (in == nullptr)
+        return SDS_INVALID;
+    /* nothing may unwind through a C caller */
+    try
+    {
+        return ctx->solver.solve(in, out, out_size);
+    }
+    catch (const std::bad_alloc&)
+    {
+        return SDS_NO_MEMORY;
+    }
+}
+
+int sds_solve_digits(sds_context* ctx, const char* in, char* out,
+    unsigned int length)
+{
+    if (in == nullptr)
+        return SDS_INVALID;
+    try
+    {
+        return ctx->solver.solveDigits(in, out, length);
+    }
+    catch (const std::bad_alloc&)
+    {
+        return SDS_NO_MEMORY;
+    }
+}
\ No newline at end of file
@@ -13,15 +13,33 @@
 #include "cli_options.h"
 #endif
 
+#include "batch.h"
 #include "cli.h"
 #include "CSVreader.h"
+#include "dlx.h"
 #include "eggs.h"
 #include "element.h"
 #include "FileHandler.h"
+#include "FixedGrid.h"
+#include "generator.h"
+#include "ParallelSearcher.h"
+#include "pipeline.h"
+#include "server.h"
+#include "solver.h"
+#include "stats.h"
+#include "trace.h"
+#include "writer.h"
 
 #include "test.cpp"
 
+#include <chrono>
+#include <climits>
+#include <cstdlib>
+#include <cstring>
 #include <getopt.h>
+#include <memory>
+#include <string>
+#include <vector>
 
 
 
@@ -31,9 +49,38 @@ int main(int argc, char** argv)
     //test1();
     //test2();
     //test3();
+    //test4();
+    //test5();
+    //test6();
 
     ///* initialize variable */
     char* filename = nullptr;
+    char* batchname = nullptr;
+    const char* engine = "logic";
+    unsigned int threads = 1;
+    bool isStats = false;
+    /* count solutions up to this many instead of solving, if not 0 */
+    unsigned long countLimit = 0;
+    bool isAllSolutions = false;
+    /* rate the puzzles of a batch instead of solving them */
+    bool isRating = false;
+    /* serve requests until the input ends, on a socket if set */
+    bool isServing = false;
+    char* socketname = nullptr;
+    /* entries of the canonical solution cache, 0 for none */
+    unsigned long cacheSize = 0;
+    /* solution store file, nullptr for none */
+    char* storename = nullptr;
+    /* read, solve and write a batch at once */
+    bool isPipelined = false;
+    /* encoding of batch solutions, and the file of their
+    records, nullptr for stdout */
+    sds::Encoding encoding = sds::enc_input;
+    char* outputname = nullptr;
+    /* puzzles to generate, and how */
+    unsigned long generateCount = 0;
+    sds::GenerateOptions generateOptions = {9, 0, sds::diff_any,
+        (std::uint64_t)std::chrono::system_clock::now().time_since_epoch().count()};
     int c;
     int option_index;
 
@@ -41,7 +88,7 @@ int main(int argc, char** argv)
     while (true)
     {
         option_index = 0;
-        c = getopt_long(argc, argv, "hvf:", long_options, &option_index);
+        c = getopt_long(argc, argv, "hvf:e:b:t:sqT:c::ag:n:k:d:S:rl::C::o:pE:w:", long_options, &option_index);
         /* detect the end of the options */
         if (c == -1)
             break;
@@ -56,6 +103,99 @@ int main(int argc, char** argv)
         case 'f':
             filename = optarg;
             break;
+        case 'e':
+            engine = optarg;
+            break;
+        case 'b':
+            batchname = optarg;
+            break;
+        case 't':
+            threads = std::atoi(optarg);
+            break;
+        case 's':
+            isStats = true;
+            break;
+        case 'q':
+            sds::setTraceLevel(sds::trace_off);
+            break;
+        case 'T':
+        {
+            sds::TraceLevel level;
+            if (!sds::parseTraceLevel(optarg, level))
+            {
+                std::fprintf(stderr, "unknown trace level \"%s\"\r\n", optarg);
+                sds::showInvalidCLIInfo();
+                exit(-1);
+            }
+            sds::setTraceLevel(level);
+            break;
+        }
+        case 'c':
+        {
+            char* end = nullptr;
+            countLimit = optarg == nullptr ? 2 : std::strtoul(optarg, &end, 10);
+            if (optarg != nullptr && (*optarg == '\0' || *end != '\0'))
+            {
+                std::fprintf(stderr, "invalid solution limit \"%s\"\r\n", optarg);
+                sds::showInvalidCLIInfo();
+                exit(-1);
+            }
+            /* 0 counts every solution */
+            if (countLimit == 0)
+                countLimit = ULONG_MAX;
+            break;
+        }
+        case 'a':
+            isAllSolutions = true;
+            break;
+        case 'g':
+            generateCount = std::strtoul(optarg, nullptr, 10);
+            break;
+        case 'n':
+            generateOptions.length = std::atoi(optarg);
+            break;
+        case 'k':
+            generateOptions.clues = std::atoi(optarg);
+            break;
+        case 'd':
+            if (!sds::parseDifficulty(optarg, generateOptions.difficulty))
+            {
+                std::fprintf(stderr, "unknown difficulty \"%s\"\r\n", optarg);
+                sds::showInvalidCLIInfo();
+                exit(-1);
+            }
+            break;
+        case 'S':
+            generateOptions.seed = std::strtoull(optarg, nullptr, 10);
+            break;
+        case 'r':
+            isRating = true;
+            break;
+        case 'l':
+            isServing = true;
+            socketname = optarg;
+            break;
+        case 'C':
+            cacheSize = optarg == nullptr ? 1 << 16 :
+                std::strtoul(optarg, nullptr, 10);
+            break;
+        case 'o':
+            storename = optarg;
+            break;
+        case 'p':
+            isPipelined = true;
+            break;
+        case 'E':
+            if (!sds::parseEncoding(optarg, encoding))
+            {
+                std::fprintf(stderr, "unknown encoding \"%s\"\r\n", optarg);
+                sds::showInvalidCLIInfo();
+                exit(-1);
+            }
+            break;
+        case 'w':
+            outputname = optarg;
+            break;
         case '?':
             break;
         default:
@@ -64,42 +204,212 @@ int main(int argc, char** argv)
         }
     }
 
+    bool isDLX = std::strcmp(engine, "dlx") == 0;
+    if (!isDLX && std::strcmp(engine, "logic") != 0)
+    {
+        std::fprintf(stderr, "unknown engine \"%s\"\r\n", engine);
+        sds::showInvalidCLIInfo();
+        exit(-1);
+    }
+
+    /* listing every solution counts them all by default */
+    if (isAllSolutions && countLimit == 0)
+        countLimit = ULONG_MAX;
+
+    /* records need a fixed size, lines by default */
+    if (outputname != nullptr && encoding == sds::enc_input)
+        encoding = sds::enc_line;
+    if ((encoding != sds::enc_input || outputname != nullptr) &&
+        (countLimit != 0 || isRating))
+    {
+        std::fprintf(stderr, "--encoding and --output apply to solutions "
+            "only\r\n");
+        sds::showInvalidCLIInfo();
+        exit(-1);
+    }
+
     int returnCode = 0;
+    sds::SolveStats stats;
+    std::unique_ptr<sds::SolutionCache> cache;
+    if (cacheSize != 0)
+        cache.reset(new sds::SolutionCache(cacheSize));
+    std::unique_ptr<sds::SolutionStore> store;
+    if (storename != nullptr)
+        store.reset(new sds::SolutionStore(storename));
+    ///* generate puzzles */
+    if (generateCount != 0)
+    {
+        const unsigned int length = generateOptions.length;
+        if (length != 4 && length != 9 && length != 16 && length != 25)
+        {
+            std::fprintf(stderr, "cannot generate %ux%u puzzles\r\n",
+                length, length);
+            sds::showInvalidCLIInfo();
+            exit(-1);
+        }
+        returnCode = sds::runGenerate(generateCount, generateOptions,
+            threads);
+    }
+
+    ///* answer puzzles as a daemon */
+    if (isServing)
+        returnCode = sds::runServe(socketname, isDLX, threads, cache.get(),
+            store.get());
+
+    ///* solve a batch of puzzles */
+    if (batchname != nullptr)
+    {
+        sds::BatchOptions options;
+        options.isDLX = isDLX;
+        options.threads = threads;
+        options.stats = isStats ? &stats : nullptr;
+        options.limit = countLimit;
+        options.isRating = isRating;
+        options.cache = cache.get();
+        options.store = store.get();
+        options.encoding = encoding;
+        std::unique_ptr<sds::RecordFile> output;
+        if (outputname != nullptr)
+        {
+            output.reset(new sds::RecordFile(outputname, encoding));
+            if (!output->isOpen())
+                exit(-1);
+            options.output = output.get();
+        }
+        if (isPipelined)
+            returnCode = sds::runPipeline(batchname, options);
+        else
+            returnCode = sds::runBatch(batchname, options);
+        if (output && !output->isGood())
+            returnCode = -1;
+        if (cache)
+            std::fprintf(stderr, "cache: %lu hits, %lu misses\r\n",
+                cache->Hits(), cache->Misses());
+        if (store)
+            std::fprintf(stderr, "store: %lu hits, %lu added\r\n",
+                store->Hits(), store->Added());
+        if (isStats)
+            sds::printStats(stats, stderr);
+    }
+
+    ///* count the solutions of a sudoku file */
+    if (filename != nullptr && countLimit != 0)
+    {
+        sds::Grid* grid = sds::CSVtoGrid(filename);
+        sds::traceFlush();
+        if (grid == nullptr)
+        {
+            std::fprintf(stderr, "Fail to load the file %s, abort...\r\n", filename);
+            abort();
+        }
+        grid->setVerbose(false);
+        if (isStats)
+            grid->setStats(&stats);
+
+        /* stream solutions in big chunks as they are found */
+        std::string out;
+        const unsigned int length = grid->Length();
+        sds::SolutionCallback printSolution = [&out, length](const char* lattices)
+        {
+            sds::formatPuzzle(lattices, length, sds::fmt_csv, out);
+            if (out.size() >= (1 << 16))
+            {
+                std::fwrite(out.data(), 1, out.size(), stdout);
+                out.clear();
+            }
+        };
+        auto startTime = std::chrono::steady_clock::now();
+        sds::Searcher searcher;
+        sds::DLXSolver dlx;
+        const sds::SolutionCallback* onSolution =
+            isAllSolutions ? &printSolution : nullptr;
+        const unsigned long count = isDLX ?
+            dlx.count(*grid, countLimit, onSolution) :
+            sds::countDispatch(*grid, searcher, countLimit, onSolution);
+        if (isDLX)
+            stats.search_nodes = dlx.Nodes();
+        stats.solve_ms = std::chrono::duration<double, std::milli>(
+            std::chrono::steady_clock::now() - startTime).count();
+        std::fwrite(out.data(), 1, out.size(), stdout);
+        if (count == countLimit)
+            std::printf("The sudoku has at least %lu solution(s)\r\n", count);
+        else
+            std::printf("The sudoku has %lu solution(s)\r\n", count);
+        std::printf("%s engine took %.3f ms\r\n", engine, stats.solve_ms);
+        std::fflush(stdout);
+        if (isStats)
+            sds::printStats(stats, stderr);
+        returnCode = count == 1 ? 0 : -1;
+    }
+
     ///* load sudoku file */
-    if (filename != nullptr)
+    if (filename != nullptr && countLimit == 0)
     {
+        auto phaseTime = std::chrono::steady_clock::now();
         sds::Grid* grid = sds::CSVtoGrid(filename);
+        sds::traceFlush();
         if (grid == nullptr)
         {
             std::fprintf(stderr, "Fail to load the file %s, abort...\r\n", filename);
             abort();
         }
+        /* loading only, printing the clues is not part of it */
+        stats.initialize_ms = std::chrono::duration<double, std::milli>(
+            std::chrono::steady_clock::now() - phaseTime).count();
         std::printf("The initialized sudoku game is:\r\n");
         grid->dispGrid();
+        if (isStats)
+            grid->setStats(&stats);
 
-        ///* initialize global vars */
-        std::printf("Initializing mask...\r\n");
-        grid->initializeMask();
-
-        ///* solve sudoku */
-        unsigned int ie = 2;
-        while (true)
+        auto startTime = std::chrono::steady_clock::now();
+        /* keep the clues, to store the solution under them */
+        std::vector<char> clues;
+        std::vector<char> stored(grid->Size());
+        if (store)
+            clues.assign(grid->Lattices(), grid->Lattices() + grid->Size());
+        const bool isStored = store &&
+            store->find(clues.data(), grid->Length(), stored.data());
+        if (isStored)
         {
-            /* kernel */
-            while(grid->fill()) { }
-            if (grid->isCompleted())
-                break;
-            if (grid->excluding(ie))
-            {
-                ie = 2;
-                continue;
-            }
-            ie++;
-            if (ie > grid->Length())
-                break;
+            ///* solved by an earlier run */
+            SDS_TRACE(sds::trace_info, "Found the solution in the store\r\n");
+            grid->load(stored.data());
+        }
+        else if (isDLX)
+        {
+            ///* solve sudoku as exact cover */
+            sds::DLXSolver dlx;
+            dlx.solve(*grid);
+            SDS_TRACE(sds::trace_info, "DLX visited %ld nodes\r\n",
+                (long)dlx.Nodes());
+            stats.search_nodes = dlx.Nodes();
+        }
+        else if (threads == 1)
+        {
+            ///* solve sudoku with the grid specialized for its size */
+            grid->setVerbose(false);
+            sds::Searcher searcher;
+            sds::solveDispatch(*grid, searcher);
+        }
+        else
+        {
+            ///* split the search tree over threads */
+            grid->setVerbose(false);
+            unsigned long nodes = 0;
+            sds::parallelDispatch(*grid, threads, nodes);
+            SDS_TRACE(sds::trace_info, "Search visited %ld nodes\r\n",
+                (long)nodes);
+            stats.search_nodes = nodes;
         }
+        phaseTime = std::chrono::steady_clock::now();
+        sds::traceFlush();
+        stats.solve_ms = std::chrono::duration<double, std::milli>(
+            phaseTime - startTime).count();
+        std::printf("%s engine took %.3f ms\r\n", engine, stats.solve_ms);
 
         ///* output the solution */
+        if (grid->isCompleted() && store && !isStored)
+            store->insert(clues.data(), grid->Lattices(), grid->Length());
         if (grid->isCompleted())
         {
             std::printf("The sudoku is compeleted\r\n");
@@ -108,9 +418,14 @@ int main(int argc, char** argv)
         }
         else
         {
-            std::fprintf(stderr, "bad sudoku: the solution of the sudoku may be multiple\r\n");
+            std::fprintf(stderr, "bad sudoku: the sudoku has no solution\r\n");
             returnCode = -1;
         }
+        std::fflush(stdout);
+        stats.output_ms = std::chrono::duration<double, std::milli>(
+            std::chrono::steady_clock::now() - phaseTime).count();
+        if (isStats)
+            sds::printStats(stats, stderr);
     }
 
     ///* play eggs */
@@ -1,9 +1,87 @@
+#include "batch.h"
+#include "canonical.h"
 #include "CSVreader.h"
+#include "dlx.h"
 #include "element.h"
 #include "FileHandler.h"
+#include "FixedGrid.h"
+#include "pipeline.h"
+#include "PuzzleReader.h"
+#include "solver.h"
+#include "store.h"
+#include "writer.h"
 
+#include <algorithm>
+#include <atomic>
 #include <cstdio>
+#include <cstring>
+#include <random>
 #include <string>
+#include <thread>
+#include <vector>
+#include <unistd.h>     // mkstemp, close, unlink
+
+/* report a failed check, a test returns how many failed */
+static int check(bool isPassed, const char* what)
+{
+    if (!isPassed)
+        std::fprintf(stderr, "check failed: %s\r\n", what);
+    return isPassed ? 0 : 1;
+}
+
+/* a solved grid of any size, shifted rows of 1..length */
+static void patternGrid(unsigned int length, char* grid)
+{
+    unsigned int block = 1;
+    while (block * block < length)
+        block++;
+    for (unsigned int i = 0; i < length * length; i++)
+    {
+        const unsigned int row = i / length;
+        grid[i] = (char)(((row % block) * block + row / block + i % length) %
+            length + 1);
+    }
+}
+
+/* is solution a complete grid that keeps the clues of puzzle? */
+static bool isValidSolution(const char* puzzle, const char* solution,
+    unsigned int length)
+{
+    unsigned int block = 1;
+    while (block * block < length)
+        block++;
+    std::vector<char> seen(3 * length * length, 0);
+    for (unsigned int i = 0; i < length * length; i++)
+    {
+        const int digit = solution[i];
+        if (digit < 1 || digit > (int)length ||
+            (puzzle[i] != 0 && puzzle[i] != digit))
+            return false;
+        const unsigned int row = i / length;
+        const unsigned int col = i % length;
+        const unsigned int box = row / block * block + col / block;
+        char* units[3] = {&seen[row * length + digit - 1],
+            &seen[(length + col) * length + digit - 1],
+            &seen[(2 * length + box) * length + digit - 1]};
+        for (char* unit : units)
+        {
+            if (*unit)
+                return false;
+            *unit = 1;
+        }
+    }
+    return true;
+}
+
+/* a new empty file to write to, removed by the caller */
+static std::string tempPath()
+{
+    char path[] = "/tmp/sds_testXXXXXX";
+    const int fd = mkstemp(path);
+    if (fd >= 0)
+        close(fd);
+    return path;
+}
 
 /* test for grid */
 void test1()
@@ -190,4 +268,377 @@ void test3()
     }
     else
         std::fprintf(stderr, "bad sudoku: the solution of the sudoku may be multiple\r\n");
+}
+
+/* test for backtracking search */
+void test4()
+{
+    std::printf("start test4...\r\n");
+    /* "AI Escargot", logic alone stalls on it */
+    const char* puzzle =
+        "1....7.9..3..2...8..96..5....53..9...1..8..."
+        "26....4...3......1..4......7..7...3..";
+    sds::Grid grid(9, 3);
+    for (int i = 0; i < 81; i++)
+        grid(i / 9, i % 9) = puzzle[i] == '.' ? 0 : puzzle[i] - '0';
+    grid.initializeMask();
+
+    sds::Searcher searcher;
+    if (searcher.search(grid))
+    {
+        std::printf("the solution is (%lu nodes):\r\n", searcher.Nodes());
+        grid.dispGrid();
+    }
+    else
+        std::fprintf(stderr, "search failed\r\n");
+}
+
+/* test for dancing links */
+void test5()
+{
+    std::printf("start test5...\r\n");
+    sds::Grid* grid = sds::CSVtoGrid("bin/example/002.csv");
+    if (grid == nullptr)
+        return;
+
+    sds::DLXSolver dlx;
+    if (dlx.solve(*grid))
+    {
+        std::printf("the solution is (%lu nodes):\r\n", dlx.Nodes());
+        grid->dispGrid();
+    }
+    else
+        std::fprintf(stderr, "dlx failed\r\n");
+}
+
+/* test for fixed grid */
+void test6()
+{
+    std::printf("start test6...\r\n");
+    sds::Grid* grid = sds::CSVtoGrid("bin/example/002.csv");
+    if (grid == nullptr)
+        return;
+
+    sds::FixedGrid<9, unsigned short> fixed;
+    if (fixed.load(grid->Lattices()) && fixed.solve())
+    {
+        std::printf("the solution is (%lu nodes):\r\n", fixed.Nodes());
+        grid->load(fixed.Lattices());
+        grid->dispGrid();
+    }
+    else
+        std::fprintf(stderr, "fixed grid failed\r\n");
+}
+
+/* test for one-line puzzle alphabets */
+int test7()
+{
+    std::printf("start test7...\r\n");
+    int failed = 0;
+    /* a hexadecimal 16x16 line where 1 ('0') is never a clue */
+    std::string line;
+    for (int i = 0; i < 256; i++)
+    {
+        const int row = i / 16;
+        const int digit = ((row % 4) * 4 + row / 4 + i % 16) % 16 + 1;
+        line += digit == 1 || i % 3 == 0 ? '.' :
+            "0123456789ABCDEF"[digit - 1];
+    }
+    std::vector<char> digits;
+    unsigned int length = 0;
+    sds::PuzzleFormat format = sds::PuzzleFormat::fmt_line;
+    failed += check(sds::parseLinePuzzle(line.c_str(), line.size(),
+        digits, length, format), "hex line without '0' parses");
+    failed += check(length == 16 && format == sds::PuzzleFormat::fmt_hex,
+        "hex line without '0' is fmt_hex");
+    bool isSame = digits.size() == line.size();
+    for (std::size_t i = 0; i < digits.size() && isSame; i++)
+        isSame = sds::lineSymbol(digits[i], format) == line[i];
+    failed += check(isSame, "hex line round trip");
+
+    /* 'G' is 16 in the digit alphabet, never hexadecimal */
+    line[1] = 'G';
+    failed += check(sds::parseLinePuzzle(line.c_str(), line.size(),
+        digits, length, format) && format == sds::PuzzleFormat::fmt_line &&
+        digits[1] == 16, "line with 'G' is fmt_line");
+    return failed;
+}
+/* test for the pipeline rings under contention */
+int test8()
+{
+    std::printf("start test8...\r\n");
+    int failed = 0;
+    const unsigned int PRODUCERS = 4;
+    const unsigned int CONSUMERS = 4;
+    const unsigned long PER_PRODUCER = 20000;
+    const unsigned long total = PRODUCERS * PER_PRODUCER;
+
+    /* every value pushed by any producer is popped exactly once */
+    sds::MpmcRing<unsigned long> mpmc(64);
+    std::vector<std::atomic<unsigned char>> seen(total);
+    for (std::atomic<unsigned char>& s : seen)
+        s.store(0);
+    std::atomic<unsigned long> popped(0);
+    std::vector<std::thread> threads;
+    for (unsigned int p = 0; p < PRODUCERS; p++)
+        threads.emplace_back([&mpmc, p, PER_PRODUCER]()
+        {
+            for (unsigned long k = 0; k < PER_PRODUCER; k++)
+                while (!mpmc.push(p * PER_PRODUCER + k))
+                    std::this_thread::yield();
+        });
+    for (unsigned int c = 0; c < CONSUMERS; c++)
+        threads.emplace_back([&mpmc, &seen, &popped, total]()
+        {
+            unsigned long value;
+            while (popped.load() < total)
+            {
+                if (!mpmc.pop(value))
+                {
+                    std::this_thread::yield();
+                    continue;
+                }
+                if (value < total)
+                    seen[value].fetch_add(1);
+                popped.fetch_add(1);
+            }
+        });
+    for (std::thread& t : threads)
+        t.join();
+    bool isOnce = popped.load() == total;
+    for (unsigned long k = 0; k < total && isOnce; k++)
+        isOnce = seen[k].load() == 1;
+    unsigned long value;
+    failed += check(isOnce && !mpmc.pop(value),
+        "mpmc ring pops every value once");
+
+    /* a single producer and consumer keep the order */
+    sds::SpscRing<unsigned long> spsc(16);
+    bool isOrdered = true;
+    std::thread producer([&spsc, total]()
+    {
+        for (unsigned long k = 0; k < total; k++)
+            while (!spsc.push(k))
+                std::this_thread::yield();
+    });
+    for (unsigned long k = 0; k < total; k++)
+    {
+        while (!spsc.pop(value))
+            std::this_thread::yield();
+        isOrdered &= value == k;
+    }
+    producer.join();
+    failed += check(isOrdered && !spsc.pop(value),
+        "spsc ring keeps the order");
+    return failed;
+}
+
+/* test for the pipelined batch */
+int test9()
+{
+    std::printf("start test9...\r\n");
+    int failed = 0;
+    const char* input = "bin/bench/easy.txt";
+    const std::string path = tempPath();
+    int code;
+    {
+        sds::RecordFile output(path.c_str(), sds::Encoding::enc_line);
+        sds::BatchOptions options;
+        options.threads = 3;
+        options.encoding = sds::Encoding::enc_line;
+        options.output = &output;
+        code = sds::runPipeline(input, options);
+        failed += check(output.isGood(), "pipeline records are written");
+    }
+    failed += check(code == 0, "pipeline solves every puzzle");
+
+    /* every record is the solution of the puzzle at its place */
+    sds::PuzzleReader puzzles(input);
+    sds::PuzzleReader solutions(path);
+    std::vector<char> puzzle;
+    std::vector<char> solution;
+    unsigned int length;
+    unsigned int solutionLength;
+    sds::PuzzleFormat format;
+    unsigned long count = 0;
+    bool isSolved = true;
+    while (puzzles.next(puzzle, length, format))
+    {
+        isSolved &= solutions.next(solution, solutionLength, format) &&
+            solutionLength == length &&
+            isValidSolution(puzzle.data(), solution.data(), length);
+        count++;
+    }
+    failed += check(count > 0 && isSolved &&
+        !solutions.next(solution, solutionLength, format),
+        "pipeline keeps the input order");
+    unlink(path.c_str());
+    return failed;
+}
+
+/* test for fixed-size records */
+int test10()
+{
+    std::printf("start test10...\r\n");
+    int failed = 0;
+    const unsigned int lengths[3] = {9, 16, 25};
+    const sds::Encoding encodings[2] =
+        {sds::Encoding::enc_csv, sds::Encoding::enc_line};
+    for (unsigned int length : lengths)
+    {
+        std::vector<char> grid(length * length);
+        patternGrid(length, grid.data());
+        for (sds::Encoding encoding : encodings)
+        {
+            /* exactly recordBytes() are written, and read back */
+            const std::size_t bytes = sds::recordBytes(encoding, length);
+            std::string record(bytes + 1, '#');
+            sds::encodeRecord(grid.data(), length, encoding, &record[0]);
+            failed += check(record[bytes] == '#', "record stays in its size");
+            record.resize(bytes);
+
+            const std::string path = tempPath();
+            std::FILE* file = std::fopen(path.c_str(), "wb");
+            std::fwrite(record.data(), 1, record.size(), file);
+            std::fclose(file);
+            sds::PuzzleReader reader(path);
+            std::vector<char> digits;
+            unsigned int readLength = 0;
+            sds::PuzzleFormat format;
+            failed += check(reader.next(digits, readLength, format) &&
+                readLength == length && digits == grid,
+                encoding == sds::Encoding::enc_csv ? "csv record round trip" :
+                "line record round trip");
+            unlink(path.c_str());
+        }
+        std::string binary(length * length + 1, '#');
+        sds::encodeRecord(grid.data(), length, sds::Encoding::enc_binary,
+            &binary[0]);
+        failed += check(sds::recordBytes(sds::Encoding::enc_binary, length) ==
+            length * length && binary.back() == '#' &&
+            std::memcmp(binary.data(), grid.data(), length * length) == 0,
+            "binary record round trip");
+    }
+    return failed;
+}
+
+/* test for canonical forms */
+int test11()
+{
+    std::printf("start test11...\r\n");
+    int failed = 0;
+    const char* text =
+        "..3.2.6..9..3.5..1..18.64....81.29..7.......8..67.82...."
+        "26.95..8..2.3..9..5.1.3..";
+    const unsigned int length = 9;
+    const unsigned int block = 3;
+    std::vector<char> puzzle(length * length);
+    for (unsigned int i = 0; i < length * length; i++)
+        puzzle[i] = text[i] == '.' ? 0 : text[i] - '0';
+    sds::Canonicalizer canonical;
+    failed += check(canonical.canonicalize(puzzle.data(), length),
+        "puzzle canonicalizes");
+    const std::string form = canonical.Form();
+    const std::uint64_t hash = canonical.Hash();
+
+    /* relabeled, transposed and shuffled copies share the form */
+    std::mt19937 random(7);
+    std::vector<char> copy(length * length);
+    std::vector<char> back(length * length);
+    std::string mapped(length * length, 0);
+    for (unsigned int round = 0; round < 20; round++)
+    {
+        unsigned int order[3] = {0, 1, 2};
+        unsigned int rows[length];
+        unsigned int cols[length];
+        std::shuffle(order, order + block, random);
+        for (unsigned int b = 0; b < block; b++)
+        {
+            unsigned int inside[3] = {0, 1, 2};
+            std::shuffle(inside, inside + block, random);
+            for (unsigned int k = 0; k < block; k++)
+                rows[b * block + k] = order[b] * block + inside[k];
+        }
+        std::shuffle(order, order + block, random);
+        for (unsigned int b = 0; b < block; b++)
+        {
+            unsigned int inside[3] = {0, 1, 2};
+            std::shuffle(inside, inside + block, random);
+            for (unsigned int k = 0; k < block; k++)
+                cols[b * block + k] = order[b] * block + inside[k];
+        }
+        char label[length + 1];
+        for (unsigned int d = 0; d <= length; d++)
+            label[d] = (char)d;
+        std::shuffle(label + 1, label + length + 1, random);
+        const bool isTransposed = round % 2 == 1;
+        for (unsigned int r = 0; r < length; r++)
+            for (unsigned int c = 0; c < length; c++)
+                copy[r * length + c] = label[(int)(isTransposed ?
+                    puzzle[cols[c] * length + rows[r]] :
+                    puzzle[rows[r] * length + cols[c]])];
+        failed += check(canonical.canonicalize(copy.data(), length) &&
+            canonical.Form() == form && canonical.Hash() == hash,
+            "symmetric copies share the form");
+        canonical.toCanonical(copy.data(), &mapped[0]);
+        canonical.fromCanonical(mapped.data(), back.data());
+        failed += check(mapped == form && back == copy,
+            "canonical layout round trip");
+    }
+
+    /* one more clue is another puzzle */
+    copy = puzzle;
+    copy[1] = 2;
+    failed += check(canonical.canonicalize(copy.data(), length) &&
+        canonical.Form() != form, "other puzzles differ");
+
+    /* the cache finds a form again */
+    sds::SolutionCache cache(16);
+    std::string solution;
+    canonical.canonicalize(puzzle.data(), length);
+    failed += check(!cache.find(canonical, solution), "cache starts empty");
+    cache.insert(canonical, std::string(length * length, 1));
+    failed += check(cache.find(canonical, solution) &&
+        solution == std::string(length * length, 1) && cache.Hits() == 1,
+        "cache finds an inserted form");
+    return failed;
+}
+
+/* test for the solution store */
+int test12()
+{
+    std::printf("start test12...\r\n");
+    int failed = 0;
+    const unsigned int length = 9;
+    std::vector<char> solution(length * length);
+    patternGrid(length, solution.data());
+    std::vector<char> puzzle = solution;
+    for (unsigned int i = 0; i < length * length; i += 2)
+        puzzle[i] = 0;
+    std::vector<char> other = puzzle;
+    other[1] = 0;
+    std::vector<char> found(length * length, 0);
+
+    const std::string path = tempPath();
+    {
+        sds::SolutionStore store(path);
+        failed += check(!store.find(puzzle.data(), length, found.data()),
+            "store starts empty");
+        failed += check(store.insert(puzzle.data(), solution.data(), length),
+            "store inserts");
+        failed += check(store.insert(puzzle.data(), solution.data(), length) &&
+            store.Added() == 1, "store inserts a puzzle once");
+        failed += check(!store.find(other.data(), length, found.data()),
+            "store misses other puzzles");
+        std::vector<char> wide(16 * 16, 0);
+        failed += check(!store.insert(wide.data(), wide.data(), 16),
+            "store keeps to its size");
+    }
+    /* another store on the file sees the solution */
+    sds::SolutionStore reopened(path);
+    failed += check(reopened.find(puzzle.data(), length, found.data()) &&
+        found == solution && reopened.Hits() == 1,
+        "store finds solutions of earlier runs");
+    unlink(path.c_str());
+    return failed;
 }
\ No newline at end of file
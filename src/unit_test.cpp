@@ -0,0 +1,86 @@
+/*******************************************
+ * @title   Sudoku Solver Unit Test
+ * @brief   run the checks of test.cpp and
+ * call libsudoku through its C interface;
+ * exits with 1 if any check fails. Run it
+ * from the project root.
+ * @author  Bin Qu
+ * @date    2026.10.17
+ * @copyright   You can edit and remodify
+ * this project.
+*******************************************/
+
+#include "sudoku.h"
+
+#include "test.cpp"
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+/* test for the C interface of libsudoku */
+int test13()
+{
+    std::printf("start test13...\r\n");
+    int failed = 0;
+    const char* line =
+        "..3.2.6..9..3.5..1..18.64....81.29..7.......8..67.82...."
+        "26.95..8..2.3..9..5.1.3..";
+    sds_context* ctx = sds_context_new();
+    if (ctx == nullptr)
+        return check(false, "context is created");
+
+    /* text in the layout of the puzzle, NUL-terminated */
+    char out[128];
+    std::vector<char> puzzle(81);
+    std::vector<char> solution(81);
+    for (unsigned int i = 0; i < 81; i++)
+        puzzle[i] = line[i] == '.' ? 0 : line[i] - '0';
+    bool isSolved = sds_solve(ctx, line, out, sizeof(out)) == SDS_SOLVED &&
+        std::strlen(out) == 81;
+    for (unsigned int i = 0; i < 81 && isSolved; i++)
+        solution[i] = out[i] - '0';
+    failed += check(isSolved &&
+        isValidSolution(puzzle.data(), solution.data(), 9),
+        "line puzzle is solved");
+    failed += check(sds_solve(ctx, line, out, 81) == SDS_BUFFER_TOO_SMALL,
+        "short buffer is refused");
+    failed += check(sds_solve(ctx, "not a puzzle", out, sizeof(out)) ==
+        SDS_INVALID && sds_solve(ctx, nullptr, out, sizeof(out)) ==
+        SDS_INVALID, "text that is no puzzle is invalid");
+    std::string twice = line;
+    twice[0] = twice[1] = '1';
+    failed += check(sds_solve(ctx, twice.c_str(), out, sizeof(out)) ==
+        SDS_UNSOLVABLE, "repeated clues are unsolvable");
+
+    /* digits, solved in place by dancing links */
+    sds_context_set_engine(ctx, SDS_ENGINE_DLX);
+    std::vector<char> digits = puzzle;
+    failed += check(sds_solve_digits(ctx, digits.data(), digits.data(), 9) ==
+        SDS_SOLVED && isValidSolution(puzzle.data(), digits.data(), 9),
+        "digits are solved in place");
+    failed += check(sds_solve_digits(ctx, digits.data(), digits.data(), 10) ==
+        SDS_INVALID, "unsupported sizes are invalid");
+    sds_context_free(ctx);
+    sds_context_free(nullptr);
+    return failed;
+}
+
+int main()
+{
+    int failed = 0;
+    failed += test7();
+    failed += test8();
+    failed += test9();
+    failed += test10();
+    failed += test11();
+    failed += test12();
+    failed += test13();
+    if (failed != 0)
+    {
+        std::fprintf(stderr, "%d check(s) failed\r\n", failed);
+        return 1;
+    }
+    std::printf("all checks passed\r\n");
+    return 0;
+}
\ No newline at end of file